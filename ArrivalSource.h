@@ -0,0 +1,218 @@
+#ifndef ARRIVALSOURCE_H
+#define ARRIVALSOURCE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <optional>
+#include <cstring>
+#include <cctype>
+using namespace std;
+
+#include "Process.h"
+#include "MappedFile.h"
+#include "Helpers.h"
+#include "RandomStream.h"
+
+// one line of the input file
+struct Arrival
+{
+  int arrival_ts, totalCpuTime, cpuBurst, ioBurst;
+};
+
+// Decodes the memory-mapped input file ("AT TC CB IO" per line) one line at
+// a time. Malformed lines and decreasing arrival times stop the run with the
+// file name and line number.
+class ArrivalReader
+{
+public:
+  ArrivalReader(const string &);
+  bool read(Arrival &);                  // false at EOF
+  size_t size() const { return count; }; // #processes in the whole file
+
+  static vector<Arrival> readAll(const string &);
+
+private:
+  const string path;
+  MappedFile file;
+  const char *p, *end;
+  int lineNo, prevTimeStamp;
+  size_t count;
+
+  static bool isBlank(const char *, const char *);
+};
+
+// Hands out one process at a time, so the simulation only creates a process
+// when simulated time reaches its arrival. The event queue then holds events
+// of live processes only, instead of one CREATE event per process of the
+// workload. Arrivals are either streamed from the input file or replayed
+// from a trace that was read once with ArrivalReader::readAll().
+//
+// Static priorities are drawn from their own RandomStream that starts at 0,
+// exactly as if the whole file had been read up front; the simulation's
+// burst draws start at size() (see firstBurstOffset()).
+class ArrivalSource
+{
+public:
+  ArrivalSource(const string &, const RandomNumbers &, const int);
+  ArrivalSource(const vector<Arrival> &, const RandomNumbers &, const int);
+
+  bool empty() const { return !hasNext; };
+  int nextTimeStamp() const { return ahead.arrival_ts; }; // arrival time of the next process
+  ProcIdx next(ProcessTable &);                           // create the next process in the table
+  size_t size() const { return count; };                  // #processes in the whole file
+  size_t firstBurstOffset() const;
+
+private:
+  optional<ArrivalReader> reader;
+  const vector<Arrival> *trace;
+  size_t traceIdx;
+
+  const RandomNumbers &randNumbers;
+  RandomStream prioRand;
+  const int maxprio;
+  size_t count;
+  bool hasNext;
+  Arrival ahead; // look-ahead line
+
+  void advance();
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+ArrivalReader::ArrivalReader(const string &inputPath)
+    : path(inputPath), file(inputPath), p(file.begin()), end(file.end()),
+      lineNo(0), prevTimeStamp(numeric_limits<int>::min()), count(0)
+{
+  if (!file.is_open())
+  {
+    cerr << "Error: cannot open input file " << path << endl;
+    exit(1);
+  }
+
+  // one cheap pass to count the processes, the bursts' random offset depends on it
+  for (const char *q = p; q < end;)
+  {
+    const char *eol = static_cast<const char *>(memchr(q, '\n', end - q));
+    if (eol == nullptr)
+    {
+      eol = end;
+    }
+    if (!isBlank(q, eol))
+    {
+      count++;
+    }
+    q = (eol < end) ? eol + 1 : end;
+  }
+}
+
+bool ArrivalReader::isBlank(const char *q, const char *eol)
+{
+  while (q < eol && isspace(static_cast<unsigned char>(*q)))
+  {
+    q++;
+  }
+  return q == eol;
+}
+
+bool ArrivalReader::read(Arrival &arrival)
+{
+  while (p < end)
+  {
+    lineNo++;
+    const char *line = p;
+    const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+    if (eol == nullptr)
+    {
+      eol = end;
+    }
+    p = (eol < end) ? eol + 1 : end;
+
+    if (isBlank(line, eol))
+    {
+      continue;
+    }
+
+    int field[4];
+    const char *q = line;
+    for (int k = 0; k < 4; k++)
+    {
+      if (!parseInt(q, eol, field[k]) ||
+          (q < eol && !isspace(static_cast<unsigned char>(*q))))
+      {
+        cerr << "Error: " << path << ":" << lineNo
+             << ": expected 4 integers \"AT TC CB IO\", got \""
+             << string(line, eol - line) << "\"" << endl;
+        exit(1);
+      }
+    }
+    if (field[0] < prevTimeStamp)
+    {
+      cerr << "Error: " << path << ":" << lineNo
+           << ": arrival time " << field[0] << " is earlier than the previous one" << endl;
+      exit(1);
+    }
+    prevTimeStamp = field[0];
+    arrival = {field[0], field[1], field[2], field[3]};
+    return true;
+  }
+  return false;
+}
+
+vector<Arrival> ArrivalReader::readAll(const string &inputPath)
+{
+  ArrivalReader reader(inputPath);
+  vector<Arrival> trace;
+  Arrival arrival;
+
+  trace.reserve(reader.size());
+  while (reader.read(arrival))
+  {
+    trace.emplace_back(arrival);
+  }
+  return trace;
+}
+
+ArrivalSource::ArrivalSource(const string &inputPath, const RandomNumbers &randNumbers, const int maxprio)
+    : reader(in_place, inputPath), trace(nullptr), traceIdx(0),
+      randNumbers(randNumbers), prioRand(randNumbers), maxprio(maxprio), count(reader->size()), hasNext(false)
+{
+  advance();
+}
+
+ArrivalSource::ArrivalSource(const vector<Arrival> &trace, const RandomNumbers &randNumbers, const int maxprio)
+    : trace(&trace), traceIdx(0),
+      randNumbers(randNumbers), prioRand(randNumbers), maxprio(maxprio), count(trace.size()), hasNext(false)
+{
+  advance();
+}
+
+size_t ArrivalSource::firstBurstOffset() const
+{
+  return randNumbers.size() == 0 ? 0 : count % randNumbers.size();
+}
+
+// fetch the next arrival into ahead, or clear hasNext at the end
+void ArrivalSource::advance()
+{
+  if (trace != nullptr)
+  {
+    hasNext = traceIdx < trace->size();
+    if (hasNext)
+    {
+      ahead = (*trace)[traceIdx++];
+    }
+    return;
+  }
+  hasNext = reader->read(ahead);
+  return;
+}
+
+ProcIdx ArrivalSource::next(ProcessTable &procs)
+{
+  const int staticPrio = prioRand.next(maxprio);
+  ProcIdx proc = procs.add(ahead.arrival_ts, ahead.totalCpuTime, ahead.cpuBurst, ahead.ioBurst, staticPrio);
+  advance();
+  return proc;
+}
+
+#endif
@@ -1,3 +1,6 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
 #include <iostream>
 #include <vector>
 #include <bitset>
@@ -7,6 +10,7 @@ using namespace std;
 
 #define BITS_PER_ULL (sizeof(unsigned long long) * CHAR_BIT)
 
+// Flat bitmap, highestPrio() scans the words from the top: O(maxprio / 64).
 class Bitmap
 {
   const size_t maxprio;
@@ -135,4 +139,129 @@ std::ostream &operator<<(std::ostream &os, const Bitmap *bitmap)
 //   cout << bitmap.highestPrio() << endl;
 
 //   return 0;
-// }
\ No newline at end of file
+// }
+
+///////////////////// HIERARCHICAL BITMAP ///////////////
+// Bitmap with summary levels on top: bit i of a word in level l+1 is set iff
+// word i of level l is non-zero, and the top level is a single word.
+// setBit/unsetBit/highestPrio touch one word per level, so with 64-bit words
+// they take 1 step up to 64 priorities, 2 up to 4096 and 3 up to 262144.
+class HierBitmap
+{
+  const size_t maxprio;
+  static const int MAX_LEVELS = 6; // 64^6 bits
+
+public:
+  // making data member public to simplify the code (anti pattern)
+  int numOfLevels;
+  size_t levelOfs[MAX_LEVELS]; // index of the first word of each level in words
+  vector<unsigned long long> words;
+
+  HierBitmap(size_t);
+  void setBit(size_t);
+  void unsetBit(size_t);
+  int highestPrio() const;
+};
+
+HierBitmap::HierBitmap(size_t maxprio)
+    : maxprio(maxprio), numOfLevels(0)
+{
+  size_t bits = maxprio > 0 ? maxprio : 1;
+  size_t total = 0;
+  do
+  {
+    size_t numOfWords = (bits + BITS_PER_ULL - 1) / BITS_PER_ULL;
+    levelOfs[numOfLevels++] = total;
+    total += numOfWords;
+    bits = numOfWords;
+  } while (bits > 1 && numOfLevels < MAX_LEVELS);
+  words.assign(total, 0);
+}
+
+void HierBitmap::setBit(size_t dynamic_prio)
+{
+  if (dynamic_prio >= maxprio)
+  {
+    cout << "Error: dynamic_prio >= maxprio." << endl;
+    return;
+  }
+  size_t idx = dynamic_prio;
+  for (int l = 0; l < numOfLevels; l++)
+  {
+    unsigned long long &word = words[levelOfs[l] + idx / BITS_PER_ULL];
+    const bool wasEmpty = (word == 0);
+    word |= 1ULL << (idx % BITS_PER_ULL);
+    if (!wasEmpty)
+    {
+      break; // upper levels already know this word is non-empty
+    }
+    idx /= BITS_PER_ULL;
+  }
+  return;
+}
+
+void HierBitmap::unsetBit(size_t dynamic_prio)
+{
+  if (dynamic_prio >= maxprio)
+  {
+    cout << "Error: dynamic_prio >= maxprio." << endl;
+    return;
+  }
+  size_t idx = dynamic_prio;
+  for (int l = 0; l < numOfLevels; l++)
+  {
+    unsigned long long &word = words[levelOfs[l] + idx / BITS_PER_ULL];
+    word &= ~(1ULL << (idx % BITS_PER_ULL));
+    if (word != 0)
+    {
+      break; // word still non-empty, upper levels stay set
+    }
+    idx /= BITS_PER_ULL;
+  }
+  return;
+}
+
+int HierBitmap::highestPrio() const
+{
+  size_t idx = 0;
+  for (int l = numOfLevels - 1; l >= 0; l--)
+  {
+    const unsigned long long word = words[levelOfs[l] + idx];
+    if (word == 0)
+    {
+      return -1; // only possible at the top level
+    }
+    idx = idx * BITS_PER_ULL + (BITS_PER_ULL - __builtin_clzll(word) - 1);
+  }
+  return static_cast<int>(idx);
+}
+
+std::ostream &operator<<(std::ostream &os, const HierBitmap *bitmap)
+{
+  const size_t numOfWords = (bitmap->numOfLevels > 1) ? bitmap->levelOfs[1] : bitmap->words.size();
+  for (size_t i = numOfWords; i > 0; i--)
+  {
+    os << bitset<BITS_PER_ULL>(bitmap->words[i - 1]);
+  }
+  return os;
+}
+/////////////////////////////////////////////////////////
+
+///////////////////// FIXED BITMAP //////////////////////
+// Single-word bitmap for a compile-time MAXPRIO <= 64. It is a plain value
+// that the compiler can keep in a register; no bounds message, no vector.
+template <size_t MAXPRIO>
+class FixedBitmap
+{
+  static_assert(MAXPRIO > 0 && MAXPRIO <= BITS_PER_ULL, "FixedBitmap holds at most 64 priorities");
+
+public:
+  unsigned long long word = 0;
+
+  void setBit(size_t dynamic_prio) { word |= 1ULL << dynamic_prio; };
+  void unsetBit(size_t dynamic_prio) { word &= ~(1ULL << dynamic_prio); };
+  int highestPrio() const { return word ? static_cast<int>(BITS_PER_ULL - __builtin_clzll(word) - 1) : -1; };
+};
+/////////////////////////////////////////////////////////
+
+#endif
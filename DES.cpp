@@ -1,47 +1,186 @@
 #include <ctype.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <iostream>
 #include <limits>
 #include <unordered_set>
 #include <map>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <array>
+#include <memory>
+#include <chrono>
+#include <type_traits>
+#include <getopt.h>
 using namespace std;
 
 #include "Process.h"
 #include "Event.h"
+#include "EventQueue.h"
+#include "TimingWheel.h"
+#include "SimContext.h"
 #include "Scheduler.h"
 #include "Helpers.h"
-
-void Simulation(multimap<int, Event *> &, const vector<int> &, const char, const int, const size_t = 4, bool = false);
+#include "RandomStream.h"
+#include "ArrivalSource.h"
+#include "Trace.h"
+#include "LatencyStats.h"
+#include "ReorderBuffer.h"
+#include "DebugDump.h"
+#include "SimStats.h"
+#include "IoDevice.h"
+
+// output and instrumentation switches of a run
+struct SimOptions
+{
+  bool verbose = false;          // -v: print every transition
+  bool dumpEvents = false;       // -e: print the event queue on every insert/remove
+  bool dumpReady = false;        // -t: print the ready queue on every scheduler call
+  bool ordered = true;           // report lines in id order, -u clears it
+  TraceWriter *trace = nullptr;  // -b: binary trace
+  LatencyStats *stats = nullptr; // -r: latency percentiles
+  bool hotStats = false;         // --stats: hot-path counters and timings
+  int numOfCpus = 1;             // -c: simulated CPUs, each with its own ready queue
+  int migrationCost = 0;         // -c n:cost: dispatch delay of a process stolen from another CPU
+  vector<IoDeviceSpec> ioDevices;       // -i: IO devices, none means IO is an infinite server
+  bool ioPerBurst = false;              // -I: pick the device per IO burst, not per process
+};
+
+// One simulated CPU: its own instance of the policy and its accounting.
+struct Cpu
+{
+  unique_ptr<Scheduler> policy;
+  Scheduler *scheduler = nullptr; // policy, or the wrapper around it (--stats, -t)
+  ProcIdx running = NOPROC;       // also set while a stolen process migrates
+  size_t queued = 0;              // processes in its ready queue
+  int totalIdle = 0, startIdle_ts = 0;
+  uint64_t dispatches = 0, steals = 0; // steals: dispatches taken from another CPU's queue
+};
+
+void Simulation(ProcessTable &, ArrivalSource &, EventQueue &, RandomStream &, const char, const int, const size_t,
+                const SimOptions &, ostream & = cout, ostream & = cerr);
+template <class Policy, class Calls = Policy>
+void PolicySimulation(ProcessTable &, ArrivalSource &, EventQueue &, RandomStream &, const char, const int,
+                      const size_t, const SimOptions &, ostream &, ostream &);
+void Summary(TextWriter &, const size_t, const int, const size_t, const long long, const int, const int, const int);
+void CpuSummary(TextWriter &, const vector<Cpu> &, const int, const int);
+void Sweep(const string &, const string &, const vector<string> &, const unsigned, const char, const SimOptions &,
+           const char *);
+bool parseSchedSpec(const string &, char &, int &, int &);
+EventQueue *createEventQueue(const char);
+template <class Policy>
+Policy *createScheduler(ProcessTable &, const size_t);
+string schedName(const char, const int);
 
 int main(int argc, char **argv)
 {
-  bool verbose = 0;
-  char *schedspec = nullptr, sched;
+  SimOptions opts;
+  char sched;
   int quantum = numeric_limits<int>::max(); // i.e. no quantum exist
-  int maxprio = 4;
+  int maxprio = DEFAULT_MAXPRIO;
   char *inputPath = nullptr, *randPath = nullptr;
-  int index, c;
+  vector<string> sweepSpecs;
+  unsigned jobs = thread::hardware_concurrency();
+  char queueKind = 'm'; // event queue backend: 'm'ultimap or timing 'w'heel
+  char *tracePath = nullptr;
+  char *reportPath = nullptr;
+  int c;
 
   opterr = 0;
 
-  while ((c = getopt(argc, argv, "vets:")) != -1)
+  enum
+  {
+    OPT_STATS = 256 // long options only
+  };
+  const struct option longOptions[] = {{"stats", no_argument, nullptr, OPT_STATS},
+                                       {nullptr, 0, nullptr, 0}};
+
+  while ((c = getopt_long(argc, argv, "vets:S:j:q:b:r:uc:i:I", longOptions, nullptr)) != -1)
     switch (c)
     {
     case 'v':
-      verbose = 1;
+      opts.verbose = true;
       break;
     case 'e':
+      opts.dumpEvents = true;
+      break;
     case 't':
-      // not implemented
+      opts.dumpReady = true;
       break;
     case 's':
-      schedspec = optarg;
       sscanf(optarg, "%c%d:%d", &sched, &quantum, &maxprio);
       break;
+    case 'S':
+    {
+      // sweep mode: comma separated list of scheduler specs, e.g. -S F,L,S,R2,P5:3,E4
+      stringstream list(optarg);
+      string spec;
+      while (getline(list, spec, ','))
+      {
+        if (!spec.empty())
+        {
+          sweepSpecs.emplace_back(spec);
+        }
+      }
+      break;
+    }
+    case 'j':
+      jobs = atoi(optarg);
+      break;
+    case 'q':
+      queueKind = optarg[0];
+      if (queueKind != 'm' && queueKind != 'w')
+      {
+        fprintf(stderr, "Unknown event queue '%s', use m (multimap) or w (timing wheel).\n", optarg);
+        return 1;
+      }
+      break;
+    case 'b':
+      // binary trace of the transitions, decode with tracedump
+      tracePath = optarg;
+      break;
+    case 'u':
+      // report lines in the order processes finish, no reorder buffer
+      opts.ordered = false;
+      break;
+    case 'r':
+      // latency percentiles report, CSV if the name ends with .csv, JSON otherwise
+      reportPath = optarg;
+      break;
+    case 'c':
+      // -c <cpus>[:<migration cost>]
+      opts.migrationCost = 0;
+      if (sscanf(optarg, "%d:%d", &opts.numOfCpus, &opts.migrationCost) < 1 || opts.numOfCpus < 1 ||
+          opts.migrationCost < 0)
+      {
+        fprintf(stderr, "Cannot understand the CPU spec '%s', use <cpus>[:<migration cost>].\n", optarg);
+        return 1;
+      }
+      break;
+    case 'i':
+      // -i <servers>[f|p],...: one IO device per entry, FIFO or priority queue
+      if (!parseIoDevices(optarg, opts.ioDevices))
+      {
+        fprintf(stderr, "Cannot understand the IO devices '%s', use <servers>[f|p],...\n", optarg);
+        return 1;
+      }
+      break;
+    case 'I':
+      // the device of an IO burst is the least loaded one, not process id % devices
+      opts.ioPerBurst = true;
+      break;
+    case OPT_STATS:
+      // counters and timings of the event loop, to stderr
+      opts.hotStats = true;
+      break;
     case '?':
-      if (optopt == 's')
+      if (optopt == 0)
+        fprintf(stderr, "Unknown option '%s'.\n", argv[optind - 1]);
+      else if (optopt == 's' || optopt == 'S' || optopt == 'j' || optopt == 'q' || optopt == 'b' || optopt == 'r' ||
+               optopt == 'c' || optopt == 'i')
         fprintf(stderr, "Option -%c requires an argument.\n", optopt);
       else if (isprint(optopt))
         fprintf(stderr, "Unknown option '-%c'.\n", optopt);
@@ -52,92 +191,441 @@ int main(int argc, char **argv)
       abort();
     }
 
-  // printf("verbose = %d, schedspec = %s, sched = %c, quantum = %d, maxprio = %d\n", verbose, schedspec, sched, quantum, maxprio);
-
   inputPath = argv[optind];
   randPath = argv[++optind];
   // printf("input file path: %s\n", inputPath);
   // printf("random file path: %s\n", randPath);
 
-  vector<int> randArray = createRandArray(randPath);
-  multimap<int, Event *> evtQ = createEventQ(inputPath, randArray, maxprio);
-  Simulation(evtQ, randArray, sched, quantum, maxprio, verbose);
+  if (!sweepSpecs.empty())
+  {
+    if (tracePath != nullptr)
+    {
+      fprintf(stderr, "Option -b cannot be combined with -S.\n");
+      return 1;
+    }
+    Sweep(inputPath, randPath, sweepSpecs, jobs, queueKind, opts, reportPath);
+    return 0;
+  }
+
+  RandomNumbers randNumbers(randPath);
+  ProcessTable procs;
+  ArrivalSource arrivals(inputPath, randNumbers, maxprio);
+  RandomStream burstRand(randNumbers, arrivals.firstBurstOffset()); // bursts draw after all static priorities
+  EventQueue *evtQ = createEventQueue(queueKind);
+  if (tracePath != nullptr)
+  {
+    opts.trace = new TraceWriter(tracePath);
+    if (!opts.trace->is_open())
+    {
+      fprintf(stderr, "Error: cannot write trace file %s\n", tracePath);
+      return 1;
+    }
+  }
+  if (reportPath != nullptr)
+  {
+    opts.stats = new LatencyStats();
+  }
+  Simulation(procs, arrivals, *evtQ, burstRand, sched, quantum, maxprio, opts);
+  if (opts.stats != nullptr && !writeLatencyReport(reportPath, {opts.stats}))
+  {
+    fprintf(stderr, "Error: cannot write report file %s\n", reportPath);
+    return 1;
+  }
+  delete opts.stats;
+  delete opts.trace;
+  delete evtQ;
 
   return 0;
 }
 
-void Simulation(multimap<int, Event *> &evtQ, const vector<int> &randArray,
-                const char sched, const int quantum, const size_t maxprio, bool verbose)
+// same rules as "-s": <letter>[<quantum>[:<maxprio>]]
+bool parseSchedSpec(const string &spec, char &sched, int &quantum, int &maxprio)
 {
-  vector<Process *>
-      procTable;
-  Event *evt;
-  Process *CURRENT_RUNNING_PROCESS = nullptr;
-  bool CALL_SCHEDULER = false;
-  int CURRENT_TIME = 0;
-  int CPU_totalIdelTime = 0, CPU_startIdeling_ts = 0;
-  int IO_crrentProcCount = 0, IO_totalIdelTime = 0, IO_startIdeling_ts = 0;
+  quantum = numeric_limits<int>::max();
+  maxprio = DEFAULT_MAXPRIO;
+  if (sscanf(spec.c_str(), "%c%d:%d", &sched, &quantum, &maxprio) < 1)
+  {
+    return false;
+  }
+  return string("FLSTRPE").find(sched) != string::npos;
+}
+
+EventQueue *createEventQueue(const char queueKind)
+{
+  if (queueKind == 'w')
+  {
+    return new WheelEventQueue();
+  }
+  return new MultimapEventQueue();
+}
 
-  Scheduler *scheduler = nullptr;
-  string schedspec;
+// a new instance of Policy; only the multi-level queues take the number of levels
+template <class Policy>
+Policy *createScheduler(ProcessTable &procs, const size_t maxprio)
+{
+  if constexpr (is_constructible<Policy, ProcessTable &, const size_t>::value)
+  {
+    return new Policy(procs, maxprio);
+  }
+  else
+  {
+    return new Policy(procs);
+  }
+}
+
+// the name the report prints for a scheduler spec, empty if there is none
+string schedName(const char sched, const int quantum)
+{
+  switch (sched)
+  {
+  case 'F':
+    return "FCFS";
+  case 'L':
+    return "LCFS";
+  case 'S':
+    return "SRTF";
+  case 'T':
+    return "PRESRTF";
+  case 'R':
+    return "RR " + to_string(quantum);
+  case 'P':
+    return "PRIO " + to_string(quantum);
+  case 'E':
+    return "PREPRIO " + to_string(quantum);
+  default:
+    return "";
+  }
+}
+
+// Runs one simulation per spec over the same input, concurrently on a pool of
+// jobs worker threads. The input and rand files are read only once; each run
+// gets its own ProcessTable, event queue and random cursors, and writes into
+// its own buffer. Buffers are printed in spec order, so the output equals the
+// concatenation of the single runs.
+void Sweep(const string &inputPath, const string &randPath, const vector<string> &specs,
+           const unsigned jobs, const char queueKind, const SimOptions &opts, const char *reportPath)
+{
+  struct Run
+  {
+    char sched;
+    int quantum, maxprio;
+    ostringstream out, err;
+    LatencyStats stats;
+  };
+  vector<Run> runs(specs.size());
+  for (size_t i = 0; i < specs.size(); i++)
+  {
+    if (!parseSchedSpec(specs[i], runs[i].sched, runs[i].quantum, runs[i].maxprio))
+    {
+      cerr << "Error: Cannot understand the scheduler spec " << specs[i] << endl;
+      exit(1);
+    }
+  }
+
+  const RandomNumbers randNumbers(randPath);
+  const vector<Arrival> trace = ArrivalReader::readAll(inputPath);
+
+  atomic<size_t> nextRun(0);
+  auto worker = [&]() {
+    for (size_t i = nextRun++; i < runs.size(); i = nextRun++)
+    {
+      Run &run = runs[i];
+      ProcessTable procs;
+      ArrivalSource arrivals(trace, randNumbers, run.maxprio);
+      RandomStream burstRand(randNumbers, arrivals.firstBurstOffset());
+      EventQueue *evtQ = createEventQueue(queueKind);
+      SimOptions runOpts = opts;
+      runOpts.stats = (reportPath != nullptr) ? &run.stats : nullptr;
+      Simulation(procs, arrivals, *evtQ, burstRand, run.sched, run.quantum, run.maxprio, runOpts, run.out, run.err);
+      delete evtQ;
+    }
+  };
+
+  vector<thread> pool;
+  for (unsigned t = 0; t < max(1u, min<unsigned>(jobs, runs.size())); t++)
+  {
+    pool.emplace_back(worker);
+  }
+  for (thread &t : pool)
+  {
+    t.join();
+  }
+
+  for (Run &run : runs)
+  {
+    cout << run.out.str();
+    cerr << run.err.str();
+  }
+
+  if (reportPath != nullptr)
+  {
+    vector<const LatencyStats *> stats;
+    for (const Run &run : runs)
+    {
+      stats.emplace_back(&run.stats);
+    }
+    if (!writeLatencyReport(reportPath, stats))
+    {
+      cerr << "Error: cannot write report file " << reportPath << endl;
+      exit(1);
+    }
+  }
+  return;
+}
+
+// Picks the event loop for the policy once per run: the loop instantiated on
+// the concrete policy calls its ready queue directly. --stats and -t put
+// wrappers in front of the policies, so they take the virtual loop.
+void Simulation(ProcessTable &procs, ArrivalSource &arrivals, EventQueue &queue, RandomStream &burstRand,
+                const char sched, const int quantum, const size_t maxprio, const SimOptions &opts,
+                ostream &out, ostream &err)
+{
+  // The policy type of a spec letter is picked here and nowhere else. The
+  // wrappers of --stats and -t only take a Scheduler, so with them the loop
+  // calls the policies through it.
+  auto run = [&](auto *policy) {
+    using Policy = remove_pointer_t<decltype(policy)>;
+    if (opts.hotStats || opts.dumpReady)
+    {
+      PolicySimulation<Policy, Scheduler>(procs, arrivals, queue, burstRand, sched, quantum, maxprio, opts, out, err);
+      return;
+    }
+    PolicySimulation<Policy>(procs, arrivals, queue, burstRand, sched, quantum, maxprio, opts, out, err);
+  };
   switch (sched)
   {
   case 'F':
-    scheduler = new FCFS();
-    schedspec = "FCFS";
+    run(static_cast<FCFS *>(nullptr));
     break;
   case 'L':
-    scheduler = new LCFS();
-    schedspec = "LCFS";
+    run(static_cast<LCFS *>(nullptr));
     break;
   case 'S':
-    schedspec = "SRTF";
-    scheduler = new SRTF();
+    run(static_cast<SRTF *>(nullptr));
+    break;
+  case 'T':
+    run(static_cast<PRESRTF *>(nullptr));
     break;
   case 'R':
-    schedspec = "RR " + to_string(quantum);
-    scheduler = new RR();
+    run(static_cast<RR *>(nullptr));
     break;
   case 'P':
-    schedspec = "PRIO " + to_string(quantum);
-    scheduler = new PRIO(maxprio);
+    if (maxprio == DEFAULT_MAXPRIO)
+    {
+      run(static_cast<PRIO<DEFAULT_MAXPRIO> *>(nullptr));
+      break;
+    }
+    run(static_cast<PRIO<> *>(nullptr));
     break;
   case 'E':
-    schedspec = "PREPRIO " + to_string(quantum);
-    scheduler = new PREPRIO(maxprio);
+    if (maxprio == DEFAULT_MAXPRIO)
+    {
+      run(static_cast<PREPRIO<DEFAULT_MAXPRIO> *>(nullptr));
+      break;
+    }
+    run(static_cast<PREPRIO<> *>(nullptr));
     break;
   default:
     // TODO: make more proper error handlers.
-    cout << "Error: Cannot understand the scheduler spec. No Scheduler object created.";
+    out << "Error: Cannot understand the scheduler spec. No Scheduler object created.";
     exit(1);
   }
+  return;
+}
+
+// The simulation itself. Every CPU runs a Policy created here; the loop calls
+// it as Calls, i.e. directly as Policy, or through Scheduler when wrapped.
+template <class Policy, class Calls>
+void PolicySimulation(ProcessTable &procs, ArrivalSource &arrivals, EventQueue &queue, RandomStream &burstRand,
+                      const char sched, const int quantum, const size_t maxprio, const SimOptions &opts,
+                      ostream &out, ostream &err)
+{
+  const bool verbose = opts.verbose;
+  TraceWriter *const trace = opts.trace;
+  LatencyStats *const stats = opts.stats;
+  const int migrationCost = opts.migrationCost;
 
-  while (!evtQ.empty())
+  Event evt;
+  bool CALL_SCHEDULER = false;
+  int CURRENT_TIME = 0;
+  int IO_crrentProcCount = 0, IO_totalIdelTime = 0, IO_startIdeling_ts = 0;
+  int totalTurnAround = 0, totalWaitTime = 0;
+
+  const string schedspec = schedName(sched, quantum);
+  if (stats != nullptr)
+  {
+    stats->schedspec = schedspec;
+  }
+
+  // -v lines and the report go through one big buffer instead of a flush per line
+  TextWriter text(out);
+
+  // --stats, -e and -t put wrappers around the queue and the policies
+  // (SimStats.h, DebugDump.h); without them the loop runs on the queue and
+  // the policies directly. The counters go innermost so they do not time the dumps.
+  unique_ptr<SimStats> hot(opts.hotStats ? new SimStats() : nullptr);
+  vector<unique_ptr<EventQueue>> queueWrappers;
+  vector<unique_ptr<Scheduler>> schedWrappers;
+  EventQueue *queueTop = &queue;
+  if (hot != nullptr)
+  {
+    queueWrappers.emplace_back(queueTop = new EventQueueCounter(*queueTop, *hot));
+  }
+  if (opts.dumpEvents)
+  {
+    queueWrappers.emplace_back(queueTop = new EventQueueDump(*queueTop, procs, text));
+  }
+  EventQueue &evtQ = *queueTop;
+  const SimContext simCtx(evtQ);
+  auto policyOf = [](const Cpu &cpu) -> Calls * {
+    if constexpr (is_same<Calls, Policy>::value)
+    {
+      return static_cast<Policy *>(cpu.policy.get()); // created as a Policy below
+    }
+    else
+    {
+      return cpu.scheduler;
+    }
+  };
+
+  // Every CPU runs its own instance of the policy (-c). A new process goes to
+  // the least loaded CPU and stays there until an idle CPU with an empty
+  // ready queue steals it.
+  vector<Cpu> cpus(opts.numOfCpus);
+  for (Cpu &cpu : cpus)
+  {
+    cpu.policy.reset(createScheduler<Policy>(procs, maxprio));
+    cpu.scheduler = cpu.policy.get();
+    if (hot != nullptr)
+    {
+      schedWrappers.emplace_back(cpu.scheduler = new SchedulerTimer(*cpu.scheduler, procs, *hot));
+    }
+    if (opts.dumpReady)
+    {
+      schedWrappers.emplace_back(cpu.scheduler = new SchedulerDump(*cpu.scheduler, procs, text));
+    }
+  }
+
+  // IO devices (-i). A blocked process is served by device id % n, or with
+  // -I by the device with the fewest processes, the lowest on ties.
+  vector<IoDevice> devices;
+  for (const IoDeviceSpec &spec : opts.ioDevices)
+  {
+    devices.emplace_back(spec, maxprio);
+  }
+  auto startIo = [&](const ProcIdx pid) {
+    ProcCold &info = procs.cold[pid];
+    size_t device = info.id % devices.size();
+    if (opts.ioPerBurst)
+    {
+      device = 0;
+      for (size_t d = 1; d < devices.size(); d++)
+      {
+        device = (devices[d].load() < devices[device].load()) ? d : device;
+      }
+    }
+    info.device = static_cast<int>(device);
+    return devices[device].arrive(procs, pid, CURRENT_TIME);
+  };
+
+  // the CPU with the fewest processes queued or running, the lowest on ties
+  auto leastLoaded = [&cpus]() {
+    int best = 0;
+    size_t bestLoad = numeric_limits<size_t>::max();
+    for (size_t c = 0; c < cpus.size(); c++)
+    {
+      const size_t load = cpus[c].queued + (cpus[c].running != NOPROC ? 1 : 0);
+      if (load < bestLoad)
+      {
+        best = static_cast<int>(c);
+        bestLoad = load;
+      }
+    }
+    return best;
+  };
+
+  // Finished processes are retired right away and their report line goes
+  // through the reorder buffer. In a quiet run the lines go straight to the
+  // output after the scheduler name; with -v, -b, -e or -t they must come
+  // after all transitions and dumps, so they wait in a spool file.
+  SpoolFile *spool = nullptr;
+  TextWriter *reportText = &text;
+  if (verbose || trace != nullptr || opts.dumpEvents || opts.dumpReady)
   {
-    evt = evtQ.extract(evtQ.begin()).mapped();
-    // cout << "New Event arriving: " << *evt << endl;
+    spool = new SpoolFile();
+    if (!spool->is_open())
+    {
+      err << "Error: cannot create a temporary file for the report" << endl;
+      exit(1);
+    }
+    reportText = new TextWriter(spool->stream());
+  }
+  else
+  {
+    text << schedspec << '\n';
+  }
+  ReorderBuffer reorder(*reportText, opts.ordered);
+
+  // a transition is printed (-v) and/or recorded in the binary trace (-b)
+  auto logTransition = [&](const Event &evt) {
+    if (verbose)
+    {
+      evt.log(procs, text);
+    }
+    if (trace != nullptr)
+    {
+      trace->log(evt, procs);
+    }
+  };
 
-    Process *const proc = evt->process;                  // this is the process the event works on
-    CURRENT_TIME = evt->timeStamp;                       // time jumps discretely
+  const auto loopStart = chrono::steady_clock::now();
+  while (!evtQ.empty() || !arrivals.empty())
+  {
+    // pull the next arrival in once simulated time reaches it; CREATE events
+    // go ahead of the other events with the same timeStamp
+    if (!arrivals.empty() && (evtQ.empty() || arrivals.nextTimeStamp() <= evtQ.nextTimeStamp()))
+    {
+      const int arrival_ts = arrivals.nextTimeStamp();
+      evtQ.pushFirst(arrival_ts, arrivals.next(procs), Trans::TRANS_TO_READY);
+    }
+
+    evt = evtQ.pop();
+    // cout << "New Event arriving: " << evt << endl;
+
+    const ProcIdx pid = evt.process;                     // this is the process the event works on
+    ProcHot *const proc = &procs.hot[pid];               // fields used on every transition
+    ProcCold *const info = &procs.cold[pid];             // accounting fields
+    CURRENT_TIME = evt.timeStamp;                        // time jumps discretely
     int timeInPrevState = CURRENT_TIME - proc->state_ts; // good for accounting
+    const uint64_t handlerStart = (hot != nullptr) ? readTicks() : 0;
+    Cpu *cpu = &cpus[info->cpu];                         // the CPU the process is on
 
-    switch (evt->transition)
+    switch (evt.transition)
     {
     case Trans::TRANS_TO_DONE:
     {
       // exit from running
       proc->remain_cb -= timeInPrevState;
       proc->remainCpuTime -= timeInPrevState;
-      CPU_startIdeling_ts = CURRENT_TIME;
-      CURRENT_RUNNING_PROCESS = nullptr;
+      cpu->startIdle_ts = CURRENT_TIME;
+      cpu->running = NOPROC;
+
+      logTransition(evt);
 
-      if (verbose)
+      procs.updateState(pid, ProcState::DONE, CURRENT_TIME);
+      info->finish_ts = CURRENT_TIME;
+      totalTurnAround += (info->finish_ts - info->arrival_ts);
+      totalWaitTime += info->totalWaiting;
+      if (stats != nullptr)
       {
-        evt->log();
+        stats->waiting.record(info->totalWaiting);
+        stats->turnaround.record(CURRENT_TIME - info->arrival_ts);
+        stats->response.record(info->firstRun_ts - info->arrival_ts);
       }
 
-      proc->updateState(ProcState::DONE, CURRENT_TIME);
-      proc->finish_ts = CURRENT_TIME;
+      // the slot is free for the next arrival, only the report line is kept
+      reorder.push(procs.reportLine(pid));
+      procs.retire(pid);
       CALL_SCHEDULER = true;
 
       break;
@@ -149,11 +637,21 @@ void Simulation(multimap<int, Event *> &evtQ, const vector<int> &randArray,
       switch (proc->state)
       {
       case ProcState::CREATED:
-        procTable.emplace_back(proc);
+        info->cpu = leastLoaded();
+        cpu = &cpus[info->cpu];
         break;
       case ProcState::BLOCKED:
-        proc->dynamicPriority = proc->staticPriority - 1;
-        proc->totalIO += proc->remain_ib;
+        proc->dynamicPriority = info->staticPriority - 1;
+        info->totalIO += timeInPrevState; // the IO burst and any wait for the device
+        if (!devices.empty())
+        {
+          // the device serves its next waiting process, if any
+          const ProcIdx next = devices[info->device].depart(procs, CURRENT_TIME);
+          if (next != NOPROC)
+          {
+            evtQ.push(CURRENT_TIME + procs.cold[next].remain_ib, next, Trans::TRANS_TO_READY);
+          }
+        }
         --IO_crrentProcCount;
         if (IO_crrentProcCount == 0)
         {
@@ -165,20 +663,20 @@ void Simulation(multimap<int, Event *> &evtQ, const vector<int> &randArray,
         // exit from running
         proc->remain_cb -= timeInPrevState;
         proc->remainCpuTime -= timeInPrevState;
-        CPU_startIdeling_ts = CURRENT_TIME;
-        CURRENT_RUNNING_PROCESS = nullptr;
+        cpu->startIdle_ts = CURRENT_TIME;
+        cpu->running = NOPROC;
+        break;
+      default:
         break;
       }
 
-      if (verbose)
-      {
-        evt->log();
-      }
+      logTransition(evt);
 
-      proc->updateState(ProcState::READY, CURRENT_TIME);
+      procs.updateState(pid, ProcState::READY, CURRENT_TIME);
 
       // must add to run queue
-      scheduler->add_to_readyQ(proc);
+      policyOf(*cpu)->add_to_readyQ(pid);
+      cpu->queued++;
       CALL_SCHEDULER = true;
 
       break;
@@ -186,21 +684,26 @@ void Simulation(multimap<int, Event *> &evtQ, const vector<int> &randArray,
 
     case Trans::TRANS_TO_RUNNING:
     {
-      proc->totalWaiting += timeInPrevState;
+      info->totalWaiting += timeInPrevState;
+      if (info->firstRun_ts < 0)
+      {
+        info->firstRun_ts = CURRENT_TIME;
+      }
+      if (stats != nullptr)
+      {
+        stats->readyLatency.record(timeInPrevState);
+      }
 
       if (proc->remain_cb <= 0)
       {
-        int cpuBurst = myrandom(proc->cpuBurst, randArray);
+        int cpuBurst = burstRand.next(info->cpuBurst);
         proc->remain_cb = min(cpuBurst, proc->remainCpuTime);
       }
       int actualBurst = min(proc->remain_cb, quantum);
-      if (verbose)
-      {
-        evt->log();
-      }
+      logTransition(evt);
 
-      proc->updateState(ProcState::RUNNING, CURRENT_TIME);
-      CPU_totalIdelTime += (CURRENT_TIME - CPU_startIdeling_ts);
+      procs.updateState(pid, ProcState::RUNNING, CURRENT_TIME);
+      cpu->totalIdle += (CURRENT_TIME - cpu->startIdle_ts);
 
       // CREATE NEXT EVENT
       int timeStamp = CURRENT_TIME + actualBurst;
@@ -208,19 +711,19 @@ void Simulation(multimap<int, Event *> &evtQ, const vector<int> &randArray,
       // create event for DONE
       if ((proc->remainCpuTime - actualBurst) == 0)
       {
-        evtQ.emplace(pair<int, Event *>(timeStamp, new Event(timeStamp, proc, Trans::TRANS_TO_DONE)));
+        evtQ.push(timeStamp, pid, Trans::TRANS_TO_DONE);
         break;
       }
 
       // create event for blocking
       if ((proc->remain_cb - actualBurst) == 0)
       {
-        evtQ.emplace(pair<int, Event *>(timeStamp, new Event(timeStamp, proc, Trans::TRANS_TO_BLOCKED)));
+        evtQ.push(timeStamp, pid, Trans::TRANS_TO_BLOCKED);
         break;
       }
 
       // create event for quantum expiration
-      evtQ.emplace(pair<int, Event *>(timeStamp, new Event(timeStamp, proc, Trans::TRANS_TO_READY)));
+      evtQ.push(timeStamp, pid, Trans::TRANS_TO_READY);
       break;
     }
 
@@ -229,17 +732,14 @@ void Simulation(multimap<int, Event *> &evtQ, const vector<int> &randArray,
       // exit from running
       proc->remain_cb -= timeInPrevState;
       proc->remainCpuTime -= timeInPrevState;
-      CPU_startIdeling_ts = CURRENT_TIME;
-      CURRENT_RUNNING_PROCESS = nullptr;
+      cpu->startIdle_ts = CURRENT_TIME;
+      cpu->running = NOPROC;
 
-      int ioBurst = myrandom(proc->ioBurst, randArray);
-      proc->remain_ib = ioBurst;
-      if (verbose)
-      {
-        evt->log();
-      }
+      int ioBurst = burstRand.next(info->ioBurst);
+      info->remain_ib = ioBurst;
+      logTransition(evt);
 
-      proc->updateState(ProcState::BLOCKED, CURRENT_TIME);
+      procs.updateState(pid, ProcState::BLOCKED, CURRENT_TIME);
 
       IO_crrentProcCount++;
       if (IO_crrentProcCount == 1)
@@ -248,9 +748,12 @@ void Simulation(multimap<int, Event *> &evtQ, const vector<int> &randArray,
       }
       CALL_SCHEDULER = true;
 
-      //create an event for when process becomes READY again
-      int timeStamp = CURRENT_TIME + ioBurst;
-      evtQ.emplace(pair<int, Event *>(timeStamp, new Event(timeStamp, proc, Trans::TRANS_TO_READY)));
+      //create an event for when process becomes READY again, unless it waits for its IO device
+      if (devices.empty() || startIo(pid))
+      {
+        int timeStamp = CURRENT_TIME + ioBurst;
+        evtQ.push(timeStamp, pid, Trans::TRANS_TO_READY);
+      }
 
       break;
     }
@@ -261,102 +764,209 @@ void Simulation(multimap<int, Event *> &evtQ, const vector<int> &randArray,
       proc->dynamicPriority--; // dynamic priority decreases even fro preemption
       proc->remain_cb -= timeInPrevState;
       proc->remainCpuTime -= timeInPrevState;
-      CPU_startIdeling_ts = CURRENT_TIME;
-      CURRENT_RUNNING_PROCESS = nullptr;
+      cpu->startIdle_ts = CURRENT_TIME;
+      cpu->running = NOPROC;
 
-      if (verbose)
-      {
-        evt->log();
-      }
+      logTransition(evt);
 
-      proc->updateState(ProcState::READY, CURRENT_TIME);
-
-      // remove the future event for the process
-      // TODO: a nother map(index) of Process_id:Event* might help?
-      for (auto iter = evtQ.begin(); iter != evtQ.end(); iter++)
-      {
-        if (iter->second->process->id == proc->id)
-        {
-          delete iter->second;
-          evtQ.erase(iter);
-          break; // there is only one future event for the process
-        }
-      }
+      procs.updateState(pid, ProcState::READY, CURRENT_TIME);
 
       // add to runqueue (no event is generated)
-      scheduler->add_to_readyQ(proc);
+      policyOf(*cpu)->add_to_readyQ(pid);
+      cpu->queued++;
       CALL_SCHEDULER = true;
 
       break;
     }
     }
 
-    //remove current event object from Memory
-    delete evt;
-    evt = nullptr;
+    if (hot != nullptr)
+    {
+      OpStats &op = hot->transitions[static_cast<int>(evt.transition)];
+      op.ticks += readTicks() - handlerStart;
+      op.calls++;
+    }
 
     if (CALL_SCHEDULER)
     {
-      // create preemption events if needed
-      if (CURRENT_RUNNING_PROCESS != nullptr && scheduler->test_preempt(CURRENT_RUNNING_PROCESS, proc, CURRENT_TIME, evtQ))
+      // create preemption events if needed (not while a stolen process migrates to the CPU)
+      if (cpu->running != NOPROC && procs.hot[cpu->running].state == ProcState::RUNNING &&
+          policyOf(*cpu)->test_preempt(cpu->running, pid, CURRENT_TIME, simCtx))
       {
-        // create event for preemption
-        evt = new Event(CURRENT_TIME, CURRENT_RUNNING_PROCESS, Trans::TRANS_TO_PREEMPT);
-        evtQ.emplace(pair<int, Event *>(CURRENT_TIME, evt));
-        CURRENT_RUNNING_PROCESS == nullptr;
+        // create event for preemption, it replaces the future event of the running process
+        evtQ.reschedule(CURRENT_TIME, cpu->running, Trans::TRANS_TO_PREEMPT);
       }
 
-      if ((*evtQ.begin()).first == CURRENT_TIME)
+      if ((!evtQ.empty() && evtQ.nextTimeStamp() == CURRENT_TIME) ||
+          (!arrivals.empty() && arrivals.nextTimeStamp() == CURRENT_TIME))
       {
         continue; // keep process next event from Event queue
       }
 
       CALL_SCHEDULER = false;
 
-      if (CURRENT_RUNNING_PROCESS == nullptr) // no process running or preemption occurs
+      for (Cpu &idle : cpus)
       {
+        if (idle.running != NOPROC) // process running or preemption occurs
+        {
+          continue;
+        }
         // cout << "Calling Scheduler..." << endl;
-        CURRENT_RUNNING_PROCESS = scheduler->get_next_process();
-        if (CURRENT_RUNNING_PROCESS == nullptr)
+        idle.running = policyOf(idle)->get_next_process();
+        if (idle.running == NOPROC)
         {
           // cout << "readyQ is empty..." << endl;
           continue;
         }
+        idle.queued--;
+        idle.dispatches++;
 
         // create event to make process runnable for same time.
-        evt = new Event(CURRENT_TIME, CURRENT_RUNNING_PROCESS, Trans::TRANS_TO_RUNNING);
-        evtQ.emplace(pair<int, Event *>(CURRENT_TIME, evt));
+        evtQ.push(CURRENT_TIME, idle.running, Trans::TRANS_TO_RUNNING);
+      }
+
+      // CPUs still idle have nothing queued: they take the next process of
+      // the CPU with the most waiting, which starts after the migration cost
+      for (size_t c = 0; cpus.size() > 1 && c < cpus.size(); c++)
+      {
+        Cpu &idle = cpus[c];
+        Cpu *victim = nullptr;
+        for (Cpu &other : cpus)
+        {
+          if (other.queued > (victim != nullptr ? victim->queued : 0))
+          {
+            victim = &other;
+          }
+        }
+        if (victim == nullptr)
+        {
+          break; // nothing waiting anywhere
+        }
+        if (idle.running != NOPROC)
+        {
+          continue;
+        }
+        idle.running = policyOf(*victim)->get_next_process();
+        victim->queued--;
+        procs.cold[idle.running].cpu = static_cast<int>(c);
+        idle.dispatches++;
+        idle.steals++;
+        evtQ.push(CURRENT_TIME + migrationCost, idle.running, Trans::TRANS_TO_RUNNING);
       }
     }
   }
 
-  delete scheduler;
+  if (hot != nullptr)
+  {
+    hot->seconds = chrono::duration<double>(chrono::steady_clock::now() - loopStart).count();
+  }
 
   IO_totalIdelTime += (CURRENT_TIME - IO_startIdeling_ts);
+  long long CPU_totalIdelTime = 0;
+  for (Cpu &cpu : cpus)
+  {
+    cpu.totalIdle += (CURRENT_TIME - cpu.startIdle_ts); // idle since its last process left
+    CPU_totalIdelTime += cpu.totalIdle;
+  }
 
-  // print schedspec
-  cout << schedspec << endl;
+  if (spool != nullptr)
+  {
+    reportText->flush();
+    delete reportText;
+    text << schedspec << '\n';
+    text.flush();
+    spool->copyTo(out);
+  }
+  Summary(text, procs.created(), CURRENT_TIME, cpus.size(), CPU_totalIdelTime, IO_totalIdelTime, totalTurnAround,
+          totalWaitTime);
+  if (cpus.size() > 1)
+  {
+    CpuSummary(text, cpus, CURRENT_TIME, migrationCost);
+  }
+  for (size_t d = 0; d < devices.size(); d++)
+  {
+    devices[d].print(text, d, CURRENT_TIME);
+  }
+  text.flush();
+  if (trace != nullptr)
+  {
+    // the trace carries the whole -v output, so the report goes there too
+    TextWriter traceText(trace->text());
+    traceText << schedspec << '\n';
+    traceText.flush();
+    spool->copyTo(trace->text());
+    Summary(traceText, procs.created(), CURRENT_TIME, cpus.size(), CPU_totalIdelTime, IO_totalIdelTime,
+            totalTurnAround, totalWaitTime);
+    if (cpus.size() > 1)
+    {
+      CpuSummary(traceText, cpus, CURRENT_TIME, migrationCost);
+    }
+    for (size_t d = 0; d < devices.size(); d++)
+    {
+      devices[d].print(traceText, d, CURRENT_TIME);
+    }
+  }
+  delete spool;
 
-  // print statistics of each processes
-  double procCount = static_cast<double>(procTable.size());
-  int totalTurnAround = 0, totalWaitTime = 0;
-  for (Process *proc : procTable)
+  if (verbose)
+  {
+    // event queue counters go to stderr to keep the graded output untouched
+    err << queue << endl;
+  }
+  if (hot != nullptr)
   {
-    totalTurnAround += (proc->finish_ts - proc->arrival_ts);
-    totalWaitTime += proc->totalWaiting;
-    cout << proc << endl;
-    delete proc;
+    hot->print(err, schedspec);
   }
 
-  // printf("SUM: %d %.2lf %.2lf %.2lf %.2lf %.3lf\n",
-  cout << "SUM: " << CURRENT_TIME << " "
-       << fixed << setprecision(2)
-       << (CURRENT_TIME - CPU_totalIdelTime) / (CURRENT_TIME / 100.0) << " " // CPU utilization
-       << (CURRENT_TIME - IO_totalIdelTime) / (CURRENT_TIME / 100.0) << " "  // IO utilization
-       << totalTurnAround / procCount << " "
-       << totalWaitTime / procCount << " "
-       << setprecision(3)
-       << procCount / (CURRENT_TIME / 100.0) << endl;
+  return;
+}
+
+// the SUM line, CPU utilization is the mean over all CPUs
+void Summary(TextWriter &out, const size_t numOfProcs, const int CURRENT_TIME, const size_t numOfCpus,
+             const long long CPU_totalIdelTime, const int IO_totalIdelTime, const int totalTurnAround,
+             const int totalWaitTime)
+{
+  const double procCount = static_cast<double>(numOfProcs);
+  const double cpuTime = static_cast<double>(CURRENT_TIME) * numOfCpus;
+
+  // fixed/setprecision formats through printf as well, so this is the same text
+  char sum[256];
+  int n = snprintf(sum, sizeof(sum), "SUM: %d %.2lf %.2lf %.2lf %.2lf %.3lf\n",
+                   CURRENT_TIME,
+                   (cpuTime - CPU_totalIdelTime) / (cpuTime / 100.0),           // CPU utilization
+                   (CURRENT_TIME - IO_totalIdelTime) / (CURRENT_TIME / 100.0),  // IO utilization
+                   totalTurnAround / procCount,
+                   totalWaitTime / procCount,
+                   procCount / (CURRENT_TIME / 100.0));
+  out.write(sum, min<size_t>(n, sizeof(sum) - 1));
+  return;
+}
+
+// per-CPU lines of a multi-CPU run (-c): utilization, dispatches and steals,
+// then how evenly the work was spread
+void CpuSummary(TextWriter &out, const vector<Cpu> &cpus, const int CURRENT_TIME, const int migrationCost)
+{
+  char line[256];
+  double minUtil = 100.0, maxUtil = 0.0, sumUtil = 0.0;
+  uint64_t steals = 0;
+  for (size_t c = 0; c < cpus.size(); c++)
+  {
+    const Cpu &cpu = cpus[c];
+    const double util = (CURRENT_TIME - cpu.totalIdle) / (CURRENT_TIME / 100.0);
+    minUtil = min(minUtil, util);
+    maxUtil = max(maxUtil, util);
+    sumUtil += util;
+    steals += cpu.steals;
+    int n = snprintf(line, sizeof(line), "CPU %zu: %.2lf dispatches=%llu steals=%llu\n", c, util,
+                     static_cast<unsigned long long>(cpu.dispatches), static_cast<unsigned long long>(cpu.steals));
+    out.write(line, min<size_t>(n, sizeof(line) - 1));
+  }
 
+  // imbalance: how far the busiest CPU is above the mean, in percent of the mean
+  const double meanUtil = sumUtil / cpus.size();
+  int n = snprintf(line, sizeof(line), "LOAD: min=%.2lf mean=%.2lf max=%.2lf imbalance=%.2lf%% migrations=%llu cost=%llu\n",
+                   minUtil, meanUtil, maxUtil, meanUtil > 0 ? (maxUtil - meanUtil) / meanUtil * 100.0 : 0.0,
+                   static_cast<unsigned long long>(steals), static_cast<unsigned long long>(steals) * migrationCost);
+  out.write(line, min<size_t>(n, sizeof(line) - 1));
   return;
 }
@@ -0,0 +1,181 @@
+#ifndef DEBUGDUMP_H
+#define DEBUGDUMP_H
+
+#include <vector>
+using namespace std;
+
+#include "Process.h"
+#include "Event.h"
+#include "EventQueue.h"
+#include "Scheduler.h"
+#include "TextWriter.h"
+
+// Debug dumps (-e, -t) as wrappers around the simulation's event queue and
+// scheduler. Simulation() only puts a wrapper in between when the option is
+// given, so a normal run executes none of this and the event loop has no
+// flag to test. The dumps go to the same TextWriter as the -v lines.
+
+// -e: the whole event queue before and after every insertion and removal,
+// events as "ts:id:TRANS" in pop order
+class EventQueueDump : public EventQueue
+{
+public:
+  EventQueueDump(EventQueue &, const ProcessTable &, TextWriter &);
+
+  bool empty() const override { return inner.empty(); };
+  size_t size() const override { return inner.size(); };
+  int nextTimeStamp() const override { return inner.nextTimeStamp(); };
+
+  void push(const int, const ProcIdx, const Trans) override;
+  void pushFirst(const int, const ProcIdx, const Trans) override;
+  Event pop() override;
+  bool cancel(const ProcIdx) override;
+  const Event *pending(const ProcIdx proc) const override { return inner.pending(proc); };
+  void snapshot(vector<Event> &events) const override { inner.snapshot(events); };
+
+private:
+  EventQueue &inner;
+  const ProcessTable &procs;
+  TextWriter &out;
+  vector<Event> events;
+
+  void add(const int, const ProcIdx, const Trans, const bool);
+  void showEvent(const Event &);
+  void showEvents(); // the last snapshot
+  void showQueue();
+};
+
+// -t: the ready queue(s) every time the scheduler is asked for the next process
+class SchedulerDump : public Scheduler
+{
+public:
+  SchedulerDump(Scheduler &, ProcessTable &, TextWriter &);
+
+  void add_to_readyQ(ProcIdx proc) override { inner.add_to_readyQ(proc); };
+  ProcIdx get_next_process() override;
+  bool test_preempt(ProcIdx currentProc, ProcIdx proc, int curtime, const SimContext &ctx) override
+  {
+    return inner.test_preempt(currentProc, proc, curtime, ctx);
+  };
+  void dump(TextWriter &os) const override { inner.dump(os); };
+
+private:
+  Scheduler &inner;
+  TextWriter &out;
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+static const char *transName(const Trans trans)
+{
+  switch (trans)
+  {
+  case Trans::TRANS_TO_READY:
+    return "READY";
+  case Trans::TRANS_TO_RUNNING:
+    return "RUNNG";
+  case Trans::TRANS_TO_BLOCKED:
+    return "BLOCK";
+  case Trans::TRANS_TO_PREEMPT:
+    return "PREEMPT";
+  case Trans::TRANS_TO_DONE:
+    return "DONE";
+  default:
+    return "Error!";
+  }
+}
+
+EventQueueDump::EventQueueDump(EventQueue &inner, const ProcessTable &procs, TextWriter &out)
+    : inner(inner), procs(procs), out(out)
+{
+}
+
+void EventQueueDump::showEvent(const Event &evt)
+{
+  out << evt.timeStamp << ':' << procs.cold[evt.process].id << ':' << transName(evt.transition);
+  return;
+}
+
+void EventQueueDump::showEvents()
+{
+  for (const Event &evt : events)
+  {
+    out << ' ';
+    showEvent(evt);
+  }
+  return;
+}
+
+void EventQueueDump::showQueue()
+{
+  inner.snapshot(events);
+  showEvents();
+  return;
+}
+
+void EventQueueDump::add(const int ts, const ProcIdx proc, const Trans trans, const bool first)
+{
+  out << "  AddEvent(";
+  showEvent(Event(ts, proc, trans));
+  out << "):";
+  showQueue();
+  first ? inner.pushFirst(ts, proc, trans) : inner.push(ts, proc, trans);
+  out << " ==>";
+  showQueue();
+  out << '\n';
+  return;
+}
+
+void EventQueueDump::push(const int ts, const ProcIdx proc, const Trans trans)
+{
+  add(ts, proc, trans, false);
+  return;
+}
+
+void EventQueueDump::pushFirst(const int ts, const ProcIdx proc, const Trans trans)
+{
+  add(ts, proc, trans, true);
+  return;
+}
+
+Event EventQueueDump::pop()
+{
+  inner.snapshot(events);
+  out << "  GetEvent(";
+  showEvent(events.front());
+  out << "):";
+  showEvents();
+  const Event evt = inner.pop();
+  out << " ==>";
+  showQueue();
+  out << '\n';
+  return evt;
+}
+
+bool EventQueueDump::cancel(const ProcIdx proc)
+{
+  if (inner.pending(proc) == nullptr)
+  {
+    return false;
+  }
+  out << "  RemoveEvent(" << procs.cold[proc].id << "):";
+  showQueue();
+  inner.cancel(proc);
+  out << " ==>";
+  showQueue();
+  out << '\n';
+  return true;
+}
+
+SchedulerDump::SchedulerDump(Scheduler &inner, ProcessTable &procs, TextWriter &out)
+    : Scheduler(procs), inner(inner), out(out)
+{
+}
+
+ProcIdx SchedulerDump::get_next_process()
+{
+  inner.dump(out);
+  out << '\n';
+  return inner.get_next_process();
+}
+
+#endif
@@ -3,9 +3,11 @@
 
 #include <iostream>
 #include <string>
+#include <cstdint>
 using namespace std;
 
 #include "Process.h"
+#include "TextWriter.h"
 
 enum class Trans : char
 {
@@ -18,62 +20,117 @@ enum class Trans : char
 
 string enumToString(Trans);
 
+// What a verbose log line shows about a transition, captured when the event
+// is handled: Event::log() prints it right away, the binary trace (Trace.h)
+// stores it and tracedump prints it later with exactly the same text.
+struct TraceRecord
+{
+  int32_t timeStamp;
+  ProcIdx process;
+  int32_t prev; // time spent in the state the process leaves
+  int32_t remain_cb, remainCpuTime;
+  int32_t prioOrIb; // dynamicPriority, remain_ib for TRANS_TO_BLOCKED
+  Trans transition;
+  ProcState state; // the state the process leaves
+  char reserved[2];
+
+  template <class Out>
+  void print(Out &) const; // one line of -v output, without the newline (Out: ostream or TextWriter)
+};
+
+static_assert(sizeof(TraceRecord) == 28, "TraceRecord is a fixed-size trace file record");
+
+// Events are 16-byte values: the event queues store them inline and pop()
+// hands them out by copy, so there is no per-event allocation or pointer.
 class Event
 {
 public:
   // making data member public to simplify the code (anti pattern)
-  Process *const process;
-  const int timeStamp;
-  const Trans transition;
+  int timeStamp;
+  ProcIdx process; // index into the ProcessTable
+  uint32_t seq;    // insertion sequence number, stamped by the EventQueue (wraps around)
+  Trans transition;
 
-  Event(const int, Process *const, const Trans);
-  void log();
+  Event() = default;
+  Event(const int, const ProcIdx, const Trans, const uint32_t = 0);
+  TraceRecord record(const ProcessTable &) const;
+  void log(const ProcessTable &, ostream & = cout) const;
+  void log(const ProcessTable &, TextWriter &) const;
 };
 
+static_assert(sizeof(Event) == 16, "Event should stay a 16-byte value");
+
 // TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
-Event::Event(const int ts, Process *const proc, const Trans trans)
-    : timeStamp(ts), process(proc), transition(trans)
+Event::Event(const int ts, const ProcIdx proc, const Trans trans, const uint32_t seq)
+    : timeStamp(ts), process(proc), seq(seq), transition(trans)
+{
+}
+
+TraceRecord Event::record(const ProcessTable &procs) const
 {
+  const ProcHot &proc = procs.hot[this->process];
+  TraceRecord rec = {};
+  rec.timeStamp = this->timeStamp;
+  rec.process = procs.cold[this->process].id; // the slot is not the process id
+  rec.prev = this->timeStamp - proc.state_ts;
+  rec.remain_cb = proc.remain_cb;
+  rec.remainCpuTime = proc.remainCpuTime;
+  rec.prioOrIb = (this->transition == Trans::TRANS_TO_BLOCKED) ? procs.cold[this->process].remain_ib
+                                                                : proc.dynamicPriority;
+  rec.transition = this->transition;
+  rec.state = proc.state;
+  return rec;
+}
+
+void Event::log(const ProcessTable &procs, ostream &out) const
+{
+  record(procs).print(out);
+  out << endl;
+  return;
+}
+
+void Event::log(const ProcessTable &procs, TextWriter &out) const
+{
+  record(procs).print(out);
+  out << '\n';
+  return;
 }
 
-void Event::log()
+template <class Out>
+void TraceRecord::print(Out &out) const
 {
-  int time = this->timeStamp;
-  const Process *proc = this->process;
-  int prev = time - proc->state_ts;
-  Trans state = this->transition;
-  cout << time << " " << proc->id << " " << prev << ": ";
-  if (state == Trans::TRANS_TO_DONE)
+  out << timeStamp << " " << process << " " << prev << ": ";
+  if (transition == Trans::TRANS_TO_DONE)
   {
-    cout << "Done" << endl;
+    out << "Done";
     return;
   }
-  cout << proc->state << " -> ";
-  switch (state)
+  out << enumToString(state) << " -> ";
+  switch (transition)
   {
   case Trans::TRANS_TO_READY:
-    cout << "READY cb=" << proc->remain_cb << " rem=" << proc->remainCpuTime << " prio=" << proc->dynamicPriority;
+    out << "READY cb=" << remain_cb << " rem=" << remainCpuTime << " prio=" << prioOrIb;
     break;
   case Trans::TRANS_TO_RUNNING:
-    cout << "RUNNG cb=" << proc->remain_cb << " rem=" << proc->remainCpuTime << " prio=" << proc->dynamicPriority;
+    out << "RUNNG cb=" << remain_cb << " rem=" << remainCpuTime << " prio=" << prioOrIb;
     break;
   case Trans::TRANS_TO_BLOCKED:
-    cout << "BLOCK  ib=" << proc->remain_ib << " rem=" << proc->remainCpuTime;
+    out << "BLOCK  ib=" << prioOrIb << " rem=" << remainCpuTime;
     break;
   case Trans::TRANS_TO_PREEMPT:
-    cout << "PREEMPT";
+    out << "PREEMPT";
     break;
   default:
     break;
   }
-  cout << endl;
   return;
 }
 
 std::ostream &operator<<(std::ostream &os, const Event &evt)
 {
   os << "timeStamp: " << evt.timeStamp << " | "
-     << "process: {" << evt.process << "} | "
+     << "process: " << evt.process << " | "
+     << "seq: " << evt.seq << " | "
      << "transition: " << enumToString(evt.transition);
   return os;
 }
@@ -0,0 +1,224 @@
+#ifndef EVENTQUEUE_H
+#define EVENTQUEUE_H
+
+#include <iostream>
+#include <map>
+#include <vector>
+#include <optional>
+#include <cstdint>
+using namespace std;
+
+#include "Process.h"
+#include "Event.h"
+
+// Discrete event queue ordered by timeStamp.
+// Events with the same timeStamp come out in insertion (FIFO) order, except
+// pushFirst() which puts an event ahead of those already queued for its time.
+// Every process has at most one pending event at any time, so a ProcIdx is
+// enough to find, cancel or replace the pending event of a process.
+// Events are stored by value and stamped with an insertion sequence number;
+// pop() returns a copy, so nothing has to be handed back.
+//
+// Backends: MultimapEventQueue (reference) and WheelEventQueue (TimingWheel.h).
+class EventQueue
+{
+public:
+  virtual ~EventQueue() = default;
+
+  virtual bool empty() const = 0;
+  virtual size_t size() const = 0;
+  virtual int nextTimeStamp() const = 0; // timeStamp of the front event, queue must not be empty
+
+  virtual void push(const int, const ProcIdx, const Trans) = 0;
+  virtual void pushFirst(const int, const ProcIdx, const Trans) = 0; // ahead of events with the same timeStamp
+  virtual Event pop() = 0;
+  virtual bool cancel(const ProcIdx) = 0;
+  virtual const Event *pending(const ProcIdx) const = 0; // valid until the queue is modified
+  virtual void snapshot(vector<Event> &) const = 0;       // all events in pop order (for -e)
+
+  void reschedule(const int, const ProcIdx, const Trans);
+
+  // counters
+  size_t highWater() const { return highWaterMark; };
+  uint64_t inserted() const { return insertCount; };
+
+protected:
+  Event make(const int, const ProcIdx, const Trans);
+
+private:
+  uint64_t insertCount = 0;
+  size_t highWaterMark = 0;
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+// replace the pending event (if any) of proc by a new one
+void EventQueue::reschedule(const int ts, const ProcIdx proc, const Trans trans)
+{
+  cancel(proc);
+  push(ts, proc, trans);
+  return;
+}
+
+// new event with the next sequence number, to be inserted right away
+Event EventQueue::make(const int ts, const ProcIdx proc, const Trans trans)
+{
+  if (size() + 1 > highWaterMark)
+  {
+    highWaterMark = size() + 1;
+  }
+  return Event(ts, proc, trans, static_cast<uint32_t>(insertCount++));
+}
+
+std::ostream &operator<<(std::ostream &os, const EventQueue &evtQ)
+{
+  os << "EventQueue: size=" << evtQ.size()
+     << " highWater=" << evtQ.highWater()
+     << " inserted=" << evtQ.inserted();
+  return os;
+}
+
+//////////////////// MULTIMAP BACKEND ///////////////////
+// Reference backend: a multimap keyed by timeStamp plus a ProcIdx -> Handle
+// index, so cancelling or replacing the pending event of a process is
+// O(log n). Tree nodes are recycled, so in steady state pushing and popping
+// events does not touch the heap.
+class MultimapEventQueue : public EventQueue
+{
+public:
+  using Handle = multimap<int, Event>::iterator;
+
+  bool empty() const override;
+  size_t size() const override;
+  int nextTimeStamp() const override;
+
+  void push(const int, const ProcIdx, const Trans) override;
+  void pushFirst(const int, const ProcIdx, const Trans) override;
+  Event pop() override;
+  bool cancel(const ProcIdx) override;
+  void cancel(Handle);
+  const Event *pending(const ProcIdx) const override;
+  void snapshot(vector<Event> &) const override;
+
+private:
+  multimap<int, Event> evtQ;
+  vector<multimap<int, Event>::node_type> spareNodes;
+  vector<optional<Handle>> index; // indexed by ProcIdx
+
+  optional<Handle> &slot(const ProcIdx);
+  Handle insert(Handle, const Event &);
+};
+
+bool MultimapEventQueue::empty() const
+{
+  return evtQ.empty();
+}
+
+size_t MultimapEventQueue::size() const
+{
+  return evtQ.size();
+}
+
+int MultimapEventQueue::nextTimeStamp() const
+{
+  return evtQ.begin()->first;
+}
+
+optional<MultimapEventQueue::Handle> &MultimapEventQueue::slot(const ProcIdx proc)
+{
+  if (proc >= index.size())
+  {
+    index.resize(proc + 1);
+  }
+  return index[proc];
+}
+
+// insert evt right before hint, or at the upper bound of its key if hint is end()
+MultimapEventQueue::Handle MultimapEventQueue::insert(Handle hint, const Event &evt)
+{
+  Handle h;
+  if (spareNodes.empty())
+  {
+    h = (hint == evtQ.end()) ? evtQ.emplace(evt.timeStamp, evt) : evtQ.emplace_hint(hint, evt.timeStamp, evt);
+  }
+  else
+  {
+    auto node = move(spareNodes.back());
+    spareNodes.pop_back();
+    node.key() = evt.timeStamp;
+    node.mapped() = evt;
+    h = (hint == evtQ.end()) ? evtQ.insert(move(node)) : evtQ.insert(hint, move(node));
+  }
+  slot(evt.process) = h;
+  return h;
+}
+
+void MultimapEventQueue::push(const int ts, const ProcIdx proc, const Trans trans)
+{
+  // multimap inserts equal keys at the upper bound, which keeps FIFO order
+  insert(evtQ.end(), make(ts, proc, trans));
+  return;
+}
+
+void MultimapEventQueue::pushFirst(const int ts, const ProcIdx proc, const Trans trans)
+{
+  // inserting right before lower_bound puts it at the front of its equal range
+  // (if lower_bound is end(), there is nothing at ts and the upper bound is the front too)
+  insert(evtQ.lower_bound(ts), make(ts, proc, trans));
+  return;
+}
+
+Event MultimapEventQueue::pop()
+{
+  const Event evt = evtQ.begin()->second;
+  optional<Handle> &s = slot(evt.process);
+  if (s && *s == evtQ.begin())
+  {
+    s.reset();
+  }
+  spareNodes.emplace_back(evtQ.extract(evtQ.begin()));
+  return evt;
+}
+
+void MultimapEventQueue::cancel(Handle h)
+{
+  optional<Handle> &s = slot(h->second.process);
+  if (s && *s == h)
+  {
+    s.reset();
+  }
+  spareNodes.emplace_back(evtQ.extract(h));
+  return;
+}
+
+bool MultimapEventQueue::cancel(const ProcIdx proc)
+{
+  optional<Handle> &s = slot(proc);
+  if (!s)
+  {
+    return false;
+  }
+  cancel(*s);
+  return true;
+}
+
+const Event *MultimapEventQueue::pending(const ProcIdx proc) const
+{
+  if (proc >= index.size() || !index[proc])
+  {
+    return nullptr;
+  }
+  return &(*index[proc])->second;
+}
+
+void MultimapEventQueue::snapshot(vector<Event> &events) const
+{
+  events.clear();
+  for (const auto &entry : evtQ)
+  {
+    events.emplace_back(entry.second);
+  }
+  return;
+}
+/////////////////////////////////////////////////////////
+
+#endif
@@ -1,89 +1,46 @@
+#ifndef HELPERS_H
+#define HELPERS_H
+
 #include <iostream>
-#include <fstream>
 #include <string>
-#include <vector>
-#include <map>
-#include <regex>
+#include <cstring>
+#include <cctype>
+#include <limits>
 using namespace std;
 
-#include "Process.h"
-#include "Event.h"
-
-vector<int> createRandArray(const string);
-int myrandom(const int, const vector<int> &);
-multimap<int, Event *> createEventQ(const string, const vector<int> &, const int);
+bool parseInt(const char *&, const char *, int &);
 
 // TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
-vector<int> createRandArray(const string randFilePath)
+// parse a (signed) decimal integer at p, skipping blanks before it.
+// stops at the first character after the number; false if there is no number.
+bool parseInt(const char *&p, const char *end, int &value)
 {
-  vector<int> randArray;
-  ifstream randFile;
-  string str;
-
-  randFile.open(randFilePath);
-
-  // get the #randNum is this file
-  getline(randFile, str);
-  const int amount = stoi(str);
-
-  // read in the randNums
-  while (getline(randFile, str))
+  while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
   {
-    if (randFile.is_open())
-    {
-      randArray.emplace_back(stoi(str));
-    }
+    p++;
   }
-  randFile.close();
-
-  if (amount != randArray.size())
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+'))
   {
-    // TODO: more appropriate error handling
-    cout << "Something wrong with the random file." << endl;
-    return {-1};
+    negative = (*p == '-');
+    p++;
   }
-
-  return randArray;
-}
-
-int myrandom(const int burst, const vector<int> &randArray)
-{
-  static int ofs = 0;
-  if (ofs >= randArray.size())
+  if (p >= end || *p < '0' || *p > '9')
   {
-    ofs = 0;
+    return false;
   }
-  return 1 + (randArray[ofs++] % burst);
-}
-
-multimap<int, Event *> createEventQ(const string inputPath, const vector<int> &randArray, const int maxprio)
-{
-  // Delimiters are spaces (\s) and/or commas
-  regex delimiter("[\\s]+");
-  ifstream inputfile;
-  multimap<int, Event *> evtQ;
-  string str;
-  int at = 0, tc = 0, cb = 0, io = 0;
-
-  inputfile.open(inputPath);
-
-  while (getline(inputfile, str))
+  long long v = 0;
+  while (p < end && *p >= '0' && *p <= '9')
   {
-    if (inputfile.is_open())
+    v = v * 10 + (*p - '0');
+    if (v > numeric_limits<int>::max())
     {
-      vector<string> tokens(sregex_token_iterator(str.begin(), str.end(), delimiter, -1), {});
-      const int timeStamp = stoi(tokens[0]);
-
-      // create a Process obj
-      const int staticPrio = myrandom(maxprio, randArray);
-      Process *proc = new Process(timeStamp, stoi(tokens[1]), stoi(tokens[2]), stoi(tokens[3]), staticPrio);
-
-      // create a Process-CREATE event obj & put it into event queue
-      Event *evt = new Event(timeStamp, proc, Trans::TRANS_TO_READY);
-      evtQ.emplace(pair<int, Event *>(timeStamp, evt));
+      return false;
     }
+    p++;
   }
-  inputfile.close();
-
-  return evtQ;
+  value = static_cast<int>(negative ? -v : v);
+  return true;
 }
+
+#endif
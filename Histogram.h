@@ -0,0 +1,108 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <cmath>
+using namespace std;
+
+// Log-linear histogram of non-negative int samples in fixed memory.
+// Values below 64 have a bucket each; above that every power of two is split
+// into 64 equal buckets, so a percentile is off by less than 1/64 (1.6%) of
+// its value, whatever the number of samples. 1664 counters cover all ints.
+class LogHistogram
+{
+public:
+  void record(int);
+  uint64_t count() const { return samples; };
+  double mean() const { return samples == 0 ? 0.0 : static_cast<double>(sum) / samples; };
+  int min() const { return samples == 0 ? 0 : minValue; };
+  int max() const { return samples == 0 ? 0 : maxValue; };
+  int percentile(const double) const; // p in [0, 100], 0 if there are no samples
+
+private:
+  static constexpr int SUB_BITS = 6;
+  static constexpr int SUB = 1 << SUB_BITS;
+  static constexpr int NUM_OF_BUCKETS = (32 - SUB_BITS) * SUB;
+
+  array<uint64_t, NUM_OF_BUCKETS> buckets = {};
+  uint64_t samples = 0;
+  long long sum = 0;
+  int minValue = numeric_limits<int>::max(), maxValue = 0;
+
+  static int bucketOf(const unsigned);
+  static long long highestIn(const int); // largest value that falls into the bucket
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+int LogHistogram::bucketOf(const unsigned v)
+{
+  if (v < SUB)
+  {
+    return static_cast<int>(v);
+  }
+  const int e = 31 - __builtin_clz(v);    // e >= SUB_BITS
+  const unsigned m = v >> (e - SUB_BITS); // SUB <= m < 2 * SUB
+  return (e - SUB_BITS + 1) * SUB + static_cast<int>(m - SUB);
+}
+
+long long LogHistogram::highestIn(const int b)
+{
+  if (b < SUB)
+  {
+    return b;
+  }
+  const int e = b / SUB + SUB_BITS - 1;
+  const long long m = b % SUB + SUB;
+  return ((m + 1) << (e - SUB_BITS)) - 1;
+}
+
+void LogHistogram::record(int value)
+{
+  if (value < 0)
+  {
+    value = 0; // times are never negative, guard the bucket index anyway
+  }
+  buckets[bucketOf(static_cast<unsigned>(value))]++;
+  samples++;
+  sum += value;
+  if (value < minValue)
+  {
+    minValue = value;
+  }
+  if (value > maxValue)
+  {
+    maxValue = value;
+  }
+  return;
+}
+
+// smallest bucket bound with at least p% of the samples at or below it,
+// clamped to the recorded range
+int LogHistogram::percentile(const double p) const
+{
+  if (samples == 0)
+  {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(ceil(p / 100.0 * samples)); // nearest rank
+  if (rank < 1)
+  {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (int b = 0; b < NUM_OF_BUCKETS; b++)
+  {
+    seen += buckets[b];
+    if (seen >= rank)
+    {
+      long long v = highestIn(b);
+      v = (v > maxValue) ? maxValue : v;
+      return static_cast<int>((v < minValue) ? minValue : v);
+    }
+  }
+  return maxValue;
+}
+
+#endif
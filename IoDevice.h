@@ -0,0 +1,143 @@
+#ifndef IODEVICE_H
+#define IODEVICE_H
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+using namespace std;
+
+#include "Process.h"
+#include "ReadyList.h"
+#include "TextWriter.h"
+
+// how -i describes one device: "<servers>[f|p]"
+struct IoDeviceSpec
+{
+  int servers;
+  bool byPriority; // 'p': the queue is ordered by static priority
+};
+
+// Comma separated device specs, e.g. "1,2p,4". False if one is malformed.
+bool parseIoDevices(const string &, vector<IoDeviceSpec> &);
+
+// An IO device with a finite number of servers (-i). A blocked process is
+// served right away if a server is free; otherwise it waits in the device's
+// queue: FIFO, or by static priority (highest first, FIFO among equals).
+// Waiting processes are linked through ProcessTable::link, which a blocked
+// process does not use otherwise, so the queue never allocates.
+// Without -i, IO is an infinite server and there are no devices.
+class IoDevice
+{
+public:
+  IoDevice(const IoDeviceSpec &, const size_t);
+
+  bool arrive(ProcessTable &, const ProcIdx, const int); // true if the process is served right away
+  ProcIdx depart(ProcessTable &, const int);             // a service ended: the process served next, or NOPROC
+  size_t load() const { return busy + waiting; };        // processes in service or waiting
+  void print(TextWriter &, const size_t, const int) const;
+
+private:
+  const int servers;
+  const bool byPriority;
+  vector<ReadyList> queue; // one level, or one per static priority
+  size_t busy, waiting, maxWaiting;
+
+  // accounting
+  uint64_t served, waited;     // services started, of which after a wait
+  long long busyArea, waitArea; // integrals of busy servers and waiting processes over time
+  long long totalWait;
+  int lastChange_ts;
+
+  void advance(const int);
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+bool parseIoDevices(const string &list, vector<IoDeviceSpec> &devices)
+{
+  stringstream ss(list);
+  string spec;
+  devices.clear();
+  while (getline(ss, spec, ','))
+  {
+    char *rest = nullptr;
+    const long servers = strtol(spec.c_str(), &rest, 10);
+    if (rest == spec.c_str() || servers < 1 || (*rest != '\0' && string(rest) != "f" && string(rest) != "p"))
+    {
+      return false;
+    }
+    devices.push_back({static_cast<int>(servers), *rest == 'p'});
+  }
+  return !devices.empty();
+}
+
+IoDevice::IoDevice(const IoDeviceSpec &spec, const size_t maxprio)
+    : servers(spec.servers), byPriority(spec.byPriority), queue(spec.byPriority ? maxprio : 1),
+      busy(0), waiting(0), maxWaiting(0), served(0), waited(0),
+      busyArea(0), waitArea(0), totalWait(0), lastChange_ts(0)
+{
+}
+
+void IoDevice::advance(const int now)
+{
+  busyArea += static_cast<long long>(busy) * (now - lastChange_ts);
+  waitArea += static_cast<long long>(waiting) * (now - lastChange_ts);
+  lastChange_ts = now;
+  return;
+}
+
+bool IoDevice::arrive(ProcessTable &procs, const ProcIdx proc, const int now)
+{
+  advance(now);
+  if (busy < static_cast<size_t>(servers))
+  {
+    busy++;
+    served++;
+    return true;
+  }
+  queue[byPriority ? procs.cold[proc].staticPriority - 1 : 0].push_back(procs, proc);
+  waiting++;
+  maxWaiting = max(maxWaiting, waiting);
+  return false;
+}
+
+ProcIdx IoDevice::depart(ProcessTable &procs, const int now)
+{
+  advance(now);
+  busy--;
+  if (waiting == 0)
+  {
+    return NOPROC;
+  }
+  ProcIdx next = NOPROC;
+  for (size_t level = queue.size(); level-- > 0 && next == NOPROC;)
+  {
+    next = queue[level].pop_front(procs);
+  }
+  waiting--;
+  busy++;
+  served++;
+  waited++;
+  totalWait += now - procs.hot[next].state_ts; // blocked since then
+  return next;
+}
+
+// "IO <k>: <util> servers= served= waited= avgQ= maxQ= avgWait=", utilization
+// of all its servers over the run and the queue it had
+void IoDevice::print(TextWriter &out, const size_t index, const int endTime) const
+{
+  const double span = endTime > 0 ? static_cast<double>(endTime) : 1.0;
+  const long long busyTotal = busyArea + static_cast<long long>(busy) * (endTime - lastChange_ts);
+  const long long waitTotal = waitArea + static_cast<long long>(waiting) * (endTime - lastChange_ts);
+  char line[256];
+  int n = snprintf(line, sizeof(line), "IO %zu: %.2lf servers=%d%s served=%llu waited=%llu avgQ=%.2lf maxQ=%zu avgWait=%.2lf\n",
+                   index, busyTotal / (span * servers / 100.0), servers, byPriority ? "p" : "",
+                   static_cast<unsigned long long>(served), static_cast<unsigned long long>(waited),
+                   waitTotal / span, maxWaiting, served == 0 ? 0.0 : static_cast<double>(totalWait) / served);
+  out.write(line, min<size_t>(n, sizeof(line) - 1));
+  return;
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef LATENCYSTATS_H
+#define LATENCYSTATS_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+using namespace std;
+
+#include "Histogram.h"
+
+// Latency distributions of one run, recorded while it runs (-r <file>):
+//   waiting       total time a process spent READY, at DONE
+//   turnaround    finish_ts - arrival_ts, at DONE
+//   readyLatency  time spent READY before each dispatch (one per CPU burst)
+//   response      first dispatch - arrival_ts, at DONE
+// Memory is fixed, however many processes the run has.
+struct LatencyStats
+{
+  string schedspec;
+  LogHistogram waiting, turnaround, readyLatency, response;
+};
+
+// Writes the percentiles of every run to path: CSV if path ends with ".csv",
+// JSON otherwise. Returns false if the file cannot be written.
+bool writeLatencyReport(const string &, const vector<const LatencyStats *> &);
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+const double PERCENTILES[] = {50, 90, 99, 99.9};
+const char *const PERCENTILE_NAMES[] = {"p50", "p90", "p99", "p99.9"};
+
+struct NamedHistogram
+{
+  const char *name;
+  const LogHistogram &hist;
+};
+
+static vector<NamedHistogram> metricsOf(const LatencyStats &stats)
+{
+  return {{"waiting", stats.waiting},
+          {"turnaround", stats.turnaround},
+          {"ready_latency", stats.readyLatency},
+          {"response", stats.response}};
+}
+
+static string fixed2(const double value)
+{
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%.2lf", value);
+  return buf;
+}
+
+bool writeLatencyReport(const string &path, const vector<const LatencyStats *> &runs)
+{
+  ofstream os(path, ios::trunc);
+  if (!os.is_open())
+  {
+    return false;
+  }
+
+  const bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+  if (csv)
+  {
+    os << "sched,metric,count,mean,min,max";
+    for (const char *name : PERCENTILE_NAMES)
+    {
+      os << "," << name;
+    }
+    os << "\n";
+    for (const LatencyStats *run : runs)
+    {
+      for (const NamedHistogram &m : metricsOf(*run))
+      {
+        os << run->schedspec << "," << m.name << "," << m.hist.count() << "," << fixed2(m.hist.mean())
+           << "," << m.hist.min() << "," << m.hist.max();
+        for (const double p : PERCENTILES)
+        {
+          os << "," << m.hist.percentile(p);
+        }
+        os << "\n";
+      }
+    }
+    return os.good();
+  }
+
+  os << "[\n";
+  for (size_t r = 0; r < runs.size(); r++)
+  {
+    os << "  {\"sched\": \"" << runs[r]->schedspec << "\"";
+    for (const NamedHistogram &m : metricsOf(*runs[r]))
+    {
+      os << ",\n    \"" << m.name << "\": {\"count\": " << m.hist.count()
+         << ", \"mean\": " << fixed2(m.hist.mean())
+         << ", \"min\": " << m.hist.min() << ", \"max\": " << m.hist.max();
+      for (size_t i = 0; i < sizeof(PERCENTILES) / sizeof(PERCENTILES[0]); i++)
+      {
+        os << ", \"" << PERCENTILE_NAMES[i] << "\": " << m.hist.percentile(PERCENTILES[i]);
+      }
+      os << "}";
+    }
+    os << "}" << (r + 1 < runs.size() ? "," : "") << "\n";
+  }
+  os << "]\n";
+  return os.good();
+}
+
+#endif
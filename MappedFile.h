@@ -0,0 +1,75 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+using namespace std;
+
+// Read-only memory mapping of a whole file.
+// An empty file maps to an empty [begin(), end()) range.
+class MappedFile
+{
+public:
+  MappedFile(const string &);
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  ~MappedFile();
+
+  bool is_open() const { return fd >= 0; };
+  const char *begin() const { return data; };
+  const char *end() const { return data + length; };
+  size_t size() const { return length; };
+
+private:
+  int fd;
+  const char *data;
+  size_t length;
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+MappedFile::MappedFile(const string &path)
+    : fd(-1), data(nullptr), length(0)
+{
+  int f = open(path.c_str(), O_RDONLY);
+  if (f < 0)
+  {
+    return;
+  }
+  struct stat st;
+  if (fstat(f, &st) < 0)
+  {
+    close(f);
+    return;
+  }
+  length = static_cast<size_t>(st.st_size);
+  if (length > 0)
+  {
+    void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, f, 0);
+    if (p == MAP_FAILED)
+    {
+      close(f);
+      length = 0;
+      return;
+    }
+    madvise(p, length, MADV_SEQUENTIAL);
+    data = static_cast<const char *>(p);
+  }
+  fd = f;
+}
+
+MappedFile::~MappedFile()
+{
+  if (data != nullptr)
+  {
+    munmap(const_cast<char *>(data), length);
+  }
+  if (fd >= 0)
+  {
+    close(fd);
+  }
+}
+
+#endif
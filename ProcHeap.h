@@ -0,0 +1,112 @@
+#ifndef PROCHEAP_H
+#define PROCHEAP_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+using namespace std;
+
+#include "Process.h"
+
+// Binary min-heap of processes keyed by an int, ties broken by insertion
+// order (FIFO), i.e. the same order a multimap<int, ProcIdx> would give.
+// Nodes are 16 bytes in one vector, so push/pop are O(log n) with no
+// per-element allocation once the vector has grown to the peak size.
+// (A radix heap would need monotone keys, which remaining CPU times are not.)
+class ProcHeap
+{
+public:
+  bool empty() const { return heap.empty(); };
+  size_t size() const { return heap.size(); };
+  ProcIdx top() const { return heap.front().proc; }; // heap must not be empty
+  int topKey() const { return heap.front().key; };   // heap must not be empty
+
+  void push(const int, const ProcIdx);
+  ProcIdx pop(); // NOPROC if the heap is empty
+  void ordered(vector<ProcIdx> &) const; // all processes in pop order
+
+private:
+  struct Node
+  {
+    int key;
+    ProcIdx proc;
+    uint64_t seq;
+  };
+  vector<Node> heap;
+  uint64_t seq = 0;
+
+  static bool before(const Node &a, const Node &b) { return a.key < b.key || (a.key == b.key && a.seq < b.seq); };
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+void ProcHeap::push(const int key, const ProcIdx proc)
+{
+  // sift up: move parents down until the new node fits
+  const Node node = {key, proc, seq++};
+  size_t i = heap.size();
+  heap.emplace_back(node);
+  while (i > 0)
+  {
+    size_t parent = (i - 1) / 2;
+    if (!before(node, heap[parent]))
+    {
+      break;
+    }
+    heap[i] = heap[parent];
+    i = parent;
+  }
+  heap[i] = node;
+  return;
+}
+
+ProcIdx ProcHeap::pop()
+{
+  if (heap.empty())
+  {
+    return NOPROC;
+  }
+  const ProcIdx proc = heap.front().proc;
+  const Node last = heap.back();
+  heap.pop_back();
+
+  // sift down: move the smaller child up until the last node fits
+  const size_t n = heap.size();
+  size_t i = 0;
+  while (n > 0)
+  {
+    size_t child = 2 * i + 1;
+    if (child >= n)
+    {
+      break;
+    }
+    if (child + 1 < n && before(heap[child + 1], heap[child]))
+    {
+      child++;
+    }
+    if (!before(heap[child], last))
+    {
+      break;
+    }
+    heap[i] = heap[child];
+    i = child;
+  }
+  if (n > 0)
+  {
+    heap[i] = last;
+  }
+  return proc;
+}
+
+void ProcHeap::ordered(vector<ProcIdx> &procs) const
+{
+  vector<Node> nodes(heap);
+  sort(nodes.begin(), nodes.end(), before);
+  procs.clear();
+  for (const Node &node : nodes)
+  {
+    procs.emplace_back(node.proc);
+  }
+  return;
+}
+
+#endif
@@ -4,8 +4,12 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <vector>
+#include <cstdint>
 using namespace std;
 
+#include "TextWriter.h"
+
 enum class ProcState : char
 {
   CREATED,
@@ -18,52 +22,131 @@ enum class ProcState : char
 
 string enumToString(ProcState);
 
-class Process
+// Processes live in a ProcessTable and are referred to by their 32-bit slot
+// index. Slots of finished processes are reused, so the printed process id
+// is kept separately (ProcCold::id).
+using ProcIdx = uint32_t;
+const ProcIdx NOPROC = UINT32_MAX; // "no process", like a nullptr
+
+// fields touched by the event loop on every transition
+struct ProcHot
 {
-public:
-  // making data member public to simplify the code (anti pattern)
-  inline static int i;
-  const int id, arrival_ts, totalCpuTime, cpuBurst, ioBurst, staticPriority;
-  int remainCpuTime, dynamicPriority, state_ts, remain_cb, remain_ib;
+  int remain_cb, remainCpuTime, dynamicPriority, state_ts;
   ProcState state;
-  int finish_ts, totalIO, totalWaiting;
+};
+
+// fields that are fixed at creation or only used for accounting
+struct ProcCold
+{
+  ProcIdx id; // process id, i.e. the order of creation
+  int arrival_ts, totalCpuTime, cpuBurst, ioBurst, staticPriority;
+  int remain_ib, finish_ts, totalIO, totalWaiting;
+  int firstRun_ts; // -1 until the first dispatch
+  int cpu;         // CPU whose ready queue the process is in or that runs it (-c)
+  int device;      // IO device of its current IO burst (-i)
   // turnAround = finish_ts - arrival_ts
+};
 
-  Process(const int, const int, const int, const int, const int);
-  void updateState(const ProcState, const int);
+// what the report prints about a finished process
+struct ReportLine
+{
+  ProcIdx id;
+  int arrival_ts, totalCpuTime, cpuBurst, ioBurst, staticPriority;
+  int finish_ts, totalIO, totalWaiting;
+
+  void print(TextWriter &) const;
+};
+
+// links of the intrusive ready lists (see ReadyList.h)
+struct ProcLink
+{
+  ProcIdx prev, next;
+};
+
+// Contiguous process store, split into a hot and a cold array so that the
+// event loop only pulls the hot fields into cache. retire() hands the slot of
+// a finished process back for the next add(), so the table only grows to
+// the peak number of live processes.
+class ProcessTable
+{
+public:
+  // making data member public to simplify the code (anti pattern)
+  vector<ProcHot> hot;
+  vector<ProcCold> cold;
+  vector<ProcLink> link;
+
+  ProcIdx add(const int, const int, const int, const int, const int);
+  void retire(const ProcIdx idx) { freeSlots.emplace_back(idx); };
+  size_t size() const { return hot.size(); }; // #slots
+  size_t live() const { return hot.size() - freeSlots.size(); };
+  size_t created() const { return numOfCreated; };
+  void updateState(const ProcIdx, const ProcState, const int);
+  ReportLine reportLine(const ProcIdx) const;
+  void report(TextWriter &, const ProcIdx) const;
+
+private:
+  vector<ProcIdx> freeSlots;
+  size_t numOfCreated = 0;
 };
 
 // TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
-Process::Process(const int at, const int ct, const int cb,
-                 const int ib, const int staticPrio)
-    : id(i++), arrival_ts(at), totalCpuTime(ct), cpuBurst(cb), ioBurst(ib), staticPriority(staticPrio),
-      remainCpuTime(totalCpuTime), dynamicPriority(staticPriority - 1), state_ts(arrival_ts),
-      remain_cb(0), remain_ib(0), state(ProcState::CREATED), finish_ts(0), totalIO(0), totalWaiting(0)
+ProcIdx ProcessTable::add(const int at, const int ct, const int cb,
+                          const int ib, const int staticPrio)
+{
+  const ProcIdx id = static_cast<ProcIdx>(numOfCreated++);
+  const ProcHot h = {0, ct, staticPrio - 1, at, ProcState::CREATED};
+  const ProcCold c = {id, at, ct, cb, ib, staticPrio, 0, 0, 0, 0, -1, 0, 0};
+  if (!freeSlots.empty())
+  {
+    const ProcIdx idx = freeSlots.back();
+    freeSlots.pop_back();
+    hot[idx] = h;
+    cold[idx] = c;
+    link[idx] = {NOPROC, NOPROC};
+    return idx;
+  }
+  const ProcIdx idx = static_cast<ProcIdx>(hot.size());
+  hot.push_back(h);
+  cold.push_back(c);
+  link.push_back({NOPROC, NOPROC});
+  return idx;
+}
+
+void ProcessTable::updateState(const ProcIdx idx, const ProcState state, const int timeStamp)
+{
+  hot[idx].state = state;
+  hot[idx].state_ts = timeStamp;
+  return;
+}
+
+ReportLine ProcessTable::reportLine(const ProcIdx idx) const
 {
+  const ProcCold &c = cold[idx];
+  return {c.id, c.arrival_ts, c.totalCpuTime, c.cpuBurst, c.ioBurst, c.staticPriority,
+          c.finish_ts, c.totalIO, c.totalWaiting};
 }
 
-void Process::updateState(const ProcState state, const int timeStamp)
+void ProcessTable::report(TextWriter &os, const ProcIdx idx) const
 {
-  this->state = state;
-  this->state_ts = timeStamp;
+  reportLine(idx).print(os);
   return;
 }
 
-std::ostream &operator<<(std::ostream &os, const Process *proc)
+void ReportLine::print(TextWriter &os) const
 {
   // printf("%04d: %4d %4d %4d %4d %1d | %5d %5d %5d %5d\n")
   // note " %4d %4d" is not equivalent to "%5d%5d"
-  os << setfill('0') << setw(4) << proc->id << ": " << setfill(' ')
-     << setw(4) << proc->arrival_ts << " "
-     << setw(4) << proc->totalCpuTime << " "
-     << setw(4) << proc->cpuBurst << " "
-     << setw(4) << proc->ioBurst << " "
-     << setw(1) << proc->staticPriority << " | "
-     << setw(5) << proc->finish_ts << " "
-     << setw(5) << (proc->finish_ts - proc->arrival_ts) << " "
-     << setw(5) << proc->totalIO << " "
-     << setw(5) << proc->totalWaiting;
-  return os;
+  os.pad(id, 4, '0') << ": ";
+  os.pad(arrival_ts, 4) << " ";
+  os.pad(totalCpuTime, 4) << " ";
+  os.pad(cpuBurst, 4) << " ";
+  os.pad(ioBurst, 4) << " ";
+  os.pad(staticPriority, 1) << " | ";
+  os.pad(finish_ts, 5) << " ";
+  os.pad(finish_ts - arrival_ts, 5) << " ";
+  os.pad(totalIO, 5) << " ";
+  os.pad(totalWaiting, 5);
+  return;
 }
 
 std::ostream &operator<<(std::ostream &os, const ProcState state)
@@ -94,4 +177,4 @@ string enumToString(ProcState state)
   }
 }
 
-#endif
\ No newline at end of file
+#endif
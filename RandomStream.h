@@ -0,0 +1,157 @@
+#ifndef RANDOMSTREAM_H
+#define RANDOMSTREAM_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+using namespace std;
+
+#include "MappedFile.h"
+#include "Helpers.h"
+
+// The random numbers of a rand file, loaded once and shared read-only by any
+// number of RandomStreams.
+//
+// Two on-disk formats are accepted:
+//  - text:   first line is the amount, then one number per line
+//  - binary: RAND_MAGIC, uint64 amount, then amount int32 (host byte order);
+//            it is memory-mapped as is, so loading costs O(1).
+// writeBinary() converts a loaded file to the binary format.
+const char RAND_MAGIC[8] = {'D', 'E', 'S', 'R', 'A', 'N', 'D', '1'};
+
+class RandomNumbers
+{
+public:
+  RandomNumbers(const string &);
+  RandomNumbers(const RandomNumbers &) = delete;
+  RandomNumbers &operator=(const RandomNumbers &) = delete;
+
+  size_t size() const { return count; };
+  int operator[](const size_t i) const { return values[i]; };
+  bool writeBinary(const string &) const;
+
+private:
+  MappedFile file;
+  vector<int32_t> parsed; // storage for the text format
+  const int32_t *values;
+  size_t count;
+
+  void loadText(const string &);
+};
+
+// A cursor over RandomNumbers: next(burst) == 1 + (rand % burst), wrapping
+// around at the end. Every stream keeps its own offset, so independent
+// sequences (or independent simulations) don't disturb each other.
+class RandomStream
+{
+public:
+  RandomStream(const RandomNumbers &, const size_t = 0);
+  int next(const int);
+  size_t tell() const { return ofs; };
+
+private:
+  const RandomNumbers &numbers;
+  size_t ofs;
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+RandomNumbers::RandomNumbers(const string &randFilePath)
+    : file(randFilePath), values(nullptr), count(0)
+{
+  if (!file.is_open())
+  {
+    cerr << "Error: cannot open random file " << randFilePath << endl;
+    exit(1);
+  }
+
+  const size_t header = sizeof(RAND_MAGIC) + sizeof(uint64_t);
+  if (file.size() >= header && memcmp(file.begin(), RAND_MAGIC, sizeof(RAND_MAGIC)) == 0)
+  {
+    uint64_t amount;
+    memcpy(&amount, file.begin() + sizeof(RAND_MAGIC), sizeof(amount));
+    if (file.size() != header + amount * sizeof(int32_t))
+    {
+      cerr << "Error: binary random file " << randFilePath << " is truncated." << endl;
+      exit(1);
+    }
+    // header is 16 bytes, so the numbers are suitably aligned in the mapping
+    values = reinterpret_cast<const int32_t *>(file.begin() + header);
+    count = amount;
+    return;
+  }
+
+  loadText(randFilePath);
+}
+
+void RandomNumbers::loadText(const string &randFilePath)
+{
+  const char *p = file.begin(), *end = file.end();
+  int amount = 0, value;
+
+  // get the #randNum is this file
+  if (!parseInt(p, end, amount) || amount < 0)
+  {
+    cerr << "Error: random file " << randFilePath << " does not start with the amount." << endl;
+    exit(1);
+  }
+  parsed.reserve(amount);
+
+  // read in the randNums
+  while (p < end)
+  {
+    while (p < end && isspace(static_cast<unsigned char>(*p)))
+    {
+      p++;
+    }
+    if (p == end)
+    {
+      break;
+    }
+    if (!parseInt(p, end, value))
+    {
+      cerr << "Error: random file " << randFilePath << " has a non-numeric entry." << endl;
+      exit(1);
+    }
+    parsed.emplace_back(value);
+  }
+
+  if (static_cast<size_t>(amount) != parsed.size())
+  {
+    cerr << "Error: random file " << randFilePath << " announces " << amount
+         << " numbers but has " << parsed.size() << "." << endl;
+    exit(1);
+  }
+
+  values = parsed.data();
+  count = parsed.size();
+  return;
+}
+
+bool RandomNumbers::writeBinary(const string &binPath) const
+{
+  ofstream out(binPath, ios::binary | ios::trunc);
+  const uint64_t amount = count;
+  out.write(RAND_MAGIC, sizeof(RAND_MAGIC));
+  out.write(reinterpret_cast<const char *>(&amount), sizeof(amount));
+  out.write(reinterpret_cast<const char *>(values), count * sizeof(int32_t));
+  return static_cast<bool>(out);
+}
+
+RandomStream::RandomStream(const RandomNumbers &numbers, const size_t ofs)
+    : numbers(numbers), ofs(numbers.size() == 0 ? 0 : ofs % numbers.size())
+{
+}
+
+int RandomStream::next(const int burst)
+{
+  if (ofs >= numbers.size())
+  {
+    ofs = 0;
+  }
+  return 1 + (numbers[ofs++] % burst);
+}
+
+#endif
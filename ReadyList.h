@@ -0,0 +1,89 @@
+#ifndef READYLIST_H
+#define READYLIST_H
+
+using namespace std;
+
+#include "Process.h"
+
+// Intrusive doubly linked FIFO of processes. The links live in
+// ProcessTable::link, so a list is just a head and a tail index: enqueue,
+// dequeue and unlink are O(1) and never allocate. A process can be on at
+// most one ReadyList at a time.
+class ReadyList
+{
+public:
+  bool empty() const { return head == NOPROC; };
+  ProcIdx front() const { return head; };
+  ProcIdx back() const { return tail; };
+
+  void push_back(ProcessTable &, const ProcIdx);
+  ProcIdx pop_front(ProcessTable &);
+  ProcIdx pop_back(ProcessTable &);
+  void remove(ProcessTable &, const ProcIdx);
+
+private:
+  ProcIdx head = NOPROC, tail = NOPROC;
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+void ReadyList::push_back(ProcessTable &procs, const ProcIdx proc)
+{
+  procs.link[proc] = {tail, NOPROC};
+  if (tail == NOPROC)
+  {
+    head = proc;
+  }
+  else
+  {
+    procs.link[tail].next = proc;
+  }
+  tail = proc;
+  return;
+}
+
+// NOPROC if the list is empty
+ProcIdx ReadyList::pop_front(ProcessTable &procs)
+{
+  const ProcIdx proc = head;
+  if (proc != NOPROC)
+  {
+    remove(procs, proc);
+  }
+  return proc;
+}
+
+// NOPROC if the list is empty
+ProcIdx ReadyList::pop_back(ProcessTable &procs)
+{
+  const ProcIdx proc = tail;
+  if (proc != NOPROC)
+  {
+    remove(procs, proc);
+  }
+  return proc;
+}
+
+void ReadyList::remove(ProcessTable &procs, const ProcIdx proc)
+{
+  const ProcLink l = procs.link[proc];
+  if (l.prev == NOPROC)
+  {
+    head = l.next;
+  }
+  else
+  {
+    procs.link[l.prev].next = l.next;
+  }
+  if (l.next == NOPROC)
+  {
+    tail = l.prev;
+  }
+  else
+  {
+    procs.link[l.next].prev = l.prev;
+  }
+  procs.link[proc] = {NOPROC, NOPROC};
+  return;
+}
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef REORDERBUFFER_H
+#define REORDERBUFFER_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <cstdlib>
+#include <unistd.h>
+using namespace std;
+
+#include "Process.h"
+#include "TextWriter.h"
+
+// Anonymous temporary file for text that has to come after output that is
+// still being produced (the report lines of a -v run come after all -v lines).
+class SpoolFile
+{
+public:
+  SpoolFile();
+  bool is_open() const { return file.is_open(); };
+  ostream &stream() { return file; };
+  void copyTo(ostream &); // everything written so far, the spool must be flushed
+
+  // binary records: append() returns the offset the bytes start at
+  streamoff append(const void *, const size_t);
+  void readAt(const streamoff, void *, const size_t);
+
+private:
+  fstream file;
+};
+
+// Prints the report lines of finished processes in id order although they
+// finish in any order. A line waits in a ring indexed by id until every
+// lower id has finished. The ring has a fixed capacity: a line too far ahead
+// of the oldest unfinished process is spilled. Spilled lines collect in a
+// heap of the same capacity, which is written to a spool file as a sorted
+// run once full; they are merged back from there in id order. So memory is
+// bounded by the capacity (plus a small read buffer per run) however long
+// one process holds the report back. Unordered, lines are printed as
+// processes finish and nothing is kept.
+class ReorderBuffer
+{
+public:
+  ReorderBuffer(TextWriter &, const bool = true, const size_t = 4096);
+  void push(const ReportLine &);
+  size_t pending() const { return count; }; // in the ring or spilled
+  size_t highWater() const { return highWaterMark; };
+  size_t capacity() const { return ring.size(); };
+  uint64_t spilled() const { return numOfSpilled; };
+
+private:
+  // a sorted run in the spool file and the lines of it read so far
+  struct Run
+  {
+    streamoff next, end;
+    vector<ReportLine> buf;
+    size_t at;
+  };
+  static constexpr size_t RUN_CHUNK = 16; // lines read from a run at a time
+
+  TextWriter &out;
+  const bool ordered;
+  vector<ReportLine> ring;
+  vector<char> filled;
+  ProcIdx nextId; // lowest id not printed yet
+  size_t count, highWaterMark;
+
+  vector<ReportLine> batch;             // spilled lines not written yet, a min-heap by id
+  vector<Run> runs;                     // written runs
+  vector<pair<ProcIdx, size_t>> heads;  // (id, run) of the first unread line of every run, a min-heap
+  unique_ptr<SpoolFile> spill;          // created with the first run
+  uint64_t numOfSpilled;
+
+  void spillLine(const ReportLine &);
+  void writeRun();
+  void readRun(const size_t);
+  bool printSpilled(); // prints the spilled line of nextId, if there is one
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+static bool laterId(const ReportLine &a, const ReportLine &b)
+{
+  return a.id > b.id;
+}
+
+ReorderBuffer::ReorderBuffer(TextWriter &out, const bool ordered, const size_t capacity)
+    : out(out), ordered(ordered), nextId(0), count(0), highWaterMark(0),
+      numOfSpilled(0)
+{
+  size_t n = 1;
+  while (n < capacity)
+  {
+    n <<= 1;
+  }
+  ring.resize(ordered ? n : 0);
+  filled.resize(ring.size(), 0);
+}
+
+void ReorderBuffer::spillLine(const ReportLine &line)
+{
+  numOfSpilled++;
+  batch.push_back(line);
+  push_heap(batch.begin(), batch.end(), laterId);
+  if (batch.size() >= ring.size())
+  {
+    writeRun();
+  }
+  return;
+}
+
+void ReorderBuffer::writeRun()
+{
+  if (spill == nullptr)
+  {
+    spill.reset(new SpoolFile());
+    if (!spill->is_open())
+    {
+      cerr << "Error: cannot create a temporary file for the report" << endl;
+      exit(1);
+    }
+  }
+  sort(batch.begin(), batch.end(), [](const ReportLine &a, const ReportLine &b) { return a.id < b.id; });
+  const size_t bytes = batch.size() * sizeof(ReportLine);
+  const streamoff begin = spill->append(batch.data(), bytes);
+  runs.push_back({begin, begin + static_cast<streamoff>(bytes), {}, 0});
+  batch.clear();
+  readRun(runs.size() - 1);
+  return;
+}
+
+// the next chunk of the run, and its first line into heads; an exhausted run frees its buffer
+void ReorderBuffer::readRun(const size_t r)
+{
+  Run &run = runs[r];
+  const size_t left = static_cast<size_t>(run.end - run.next) / sizeof(ReportLine);
+  if (left == 0)
+  {
+    vector<ReportLine>().swap(run.buf);
+    return;
+  }
+  run.buf.resize(min(left, RUN_CHUNK));
+  spill->readAt(run.next, run.buf.data(), run.buf.size() * sizeof(ReportLine));
+  run.next += static_cast<streamoff>(run.buf.size() * sizeof(ReportLine));
+  run.at = 0;
+  heads.emplace_back(run.buf[0].id, r);
+  push_heap(heads.begin(), heads.end(), greater<pair<ProcIdx, size_t>>());
+  return;
+}
+
+bool ReorderBuffer::printSpilled()
+{
+  if (!batch.empty() && batch.front().id == nextId)
+  {
+    batch.front().print(out);
+    pop_heap(batch.begin(), batch.end(), laterId);
+    batch.pop_back();
+    return true;
+  }
+  if (heads.empty() || heads.front().first != nextId)
+  {
+    return false;
+  }
+  const size_t r = heads.front().second;
+  pop_heap(heads.begin(), heads.end(), greater<pair<ProcIdx, size_t>>());
+  heads.pop_back();
+  Run &run = runs[r];
+  run.buf[run.at].print(out);
+  if (++run.at < run.buf.size())
+  {
+    heads.emplace_back(run.buf[run.at].id, r);
+    push_heap(heads.begin(), heads.end(), greater<pair<ProcIdx, size_t>>());
+  }
+  else
+  {
+    readRun(r);
+  }
+  return true;
+}
+
+void ReorderBuffer::push(const ReportLine &line)
+{
+  if (!ordered)
+  {
+    line.print(out);
+    out << '\n';
+    return;
+  }
+
+  const size_t mask = ring.size() - 1;
+  if (line.id - nextId >= ring.size())
+  {
+    spillLine(line);
+  }
+  else
+  {
+    ring[line.id & mask] = line;
+    filled[line.id & mask] = 1;
+  }
+  if (++count > highWaterMark)
+  {
+    highWaterMark = count;
+  }
+
+  // a filled slot at nextId can only hold the line of nextId
+  for (;;)
+  {
+    if (filled[nextId & mask])
+    {
+      ring[nextId & mask].print(out);
+      filled[nextId & mask] = 0;
+    }
+    else if (!printSpilled())
+    {
+      break;
+    }
+    out << '\n';
+    nextId++;
+    count--;
+  }
+  return;
+}
+
+SpoolFile::SpoolFile()
+{
+  const char *dir = getenv("TMPDIR");
+  string path = string((dir != nullptr && *dir != '\0') ? dir : "/tmp") + "/DESspoolXXXXXX";
+  const int fd = mkstemp(&path[0]);
+  if (fd < 0)
+  {
+    return;
+  }
+  close(fd);
+  file.open(path, ios::in | ios::out | ios::binary | ios::trunc);
+  unlink(path.c_str()); // goes away with the stream
+}
+
+streamoff SpoolFile::append(const void *data, const size_t bytes)
+{
+  file.seekp(0, ios::end);
+  const streamoff ofs = file.tellp();
+  file.write(static_cast<const char *>(data), bytes);
+  return ofs;
+}
+
+void SpoolFile::readAt(const streamoff ofs, void *data, const size_t bytes)
+{
+  file.seekg(ofs);
+  file.read(static_cast<char *>(data), bytes);
+  return;
+}
+
+void SpoolFile::copyTo(ostream &os)
+{
+  file.flush();
+  if (file.tellp() <= 0)
+  {
+    return; // streaming an empty rdbuf() would set failbit on os
+  }
+  file.seekg(0);
+  os << file.rdbuf();
+  file.clear();
+  return;
+}
+
+#endif
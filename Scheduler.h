@@ -4,407 +4,399 @@
 #include <map>
 #include <deque>
 #include <vector>
+#include <array>
 using namespace std;
 
 #include "Process.h"
 #include "Event.h"
+#include "TextWriter.h"
+#include "SimContext.h"
 #include "Bitmap.h"
+#include "ReadyList.h"
+#include "ProcHeap.h"
 
+// The policies below are final: Simulation() runs the event loop on the
+// concrete type (PolicySimulation<FCFS>, ...), so their calls are direct and
+// can be inlined. Wrappers and plug-in schedulers go through the virtual calls.
 class Scheduler
 {
 public:
-  virtual void add_to_readyQ(Process *) = 0;
-  virtual Process *get_next_process() = 0;
-  virtual bool test_preempt(Process *, Process *, int, multimap<int, Event *>) = 0; // only for PREPRIO
+  Scheduler(ProcessTable &procs) : procs(procs){};
+  virtual ~Scheduler() = default;
+  virtual void add_to_readyQ(ProcIdx) = 0;
+  virtual ProcIdx get_next_process() = 0;                                   // NOPROC if readyQ is empty
+  virtual bool test_preempt(ProcIdx, ProcIdx, int, const SimContext &) = 0; // only PREPRIO and PRESRTF preempt
+  virtual void dump(TextWriter &) const = 0;                                // ready queue in pick order (-t)
 
 protected:
   // we can define data members that are for all derived class here.
-};
-
-// TODO: Refactory to reduce duplicate codes. HOW?
-
-//////////////// PREEMPTIVE PRIORITY ////////////////////
-class PREPRIO : public Scheduler
-{
-public:
-  PREPRIO(const size_t);
-  ~PREPRIO();
-  void add_to_readyQ(Process *) override;
-  Process *get_next_process() override;
-  bool test_preempt(Process *, Process *, int, multimap<int, Event *>) override;
+  ProcessTable &procs;
 
-private:
-  vector<deque<Process *> *> q1, q2;
-  vector<deque<Process *> *> *activeQ_ptr, *expiredQ_ptr;
-  Bitmap q1Bmap, q2Bmap;
-  Bitmap *activeBmap_ptr, *expiredBmap_ptr;
+  // " id:ts" of a ready process, ts is when it became ready
+  void dumpProc(TextWriter &out, const ProcIdx proc) const { out << ' ' << procs.cold[proc].id << ':' << procs.hot[proc].state_ts; };
+  void dumpLevels(TextWriter &, const ReadyList *, const size_t) const;
 };
 
-PREPRIO::PREPRIO(const size_t maxprio)
-    : q1(maxprio, nullptr), q2(maxprio, nullptr),
-      q1Bmap(maxprio), q2Bmap(maxprio),
-      activeQ_ptr(&q1), expiredQ_ptr(&q2),
-      activeBmap_ptr(&q1Bmap), expiredBmap_ptr(&q2Bmap)
-{
-}
-
-PREPRIO::~PREPRIO()
+// "[..][..]" from the highest priority level down, ids comma separated
+void Scheduler::dumpLevels(TextWriter &out, const ReadyList *levels, const size_t numOfLevels) const
 {
-  for (deque<Process *> *readyQ_ptr : *activeQ_ptr)
-  {
-    if (readyQ_ptr != nullptr)
-    {
-      delete readyQ_ptr;
-    }
-  }
-  for (deque<Process *> *readyQ_ptr : *expiredQ_ptr)
+  for (size_t prio = numOfLevels; prio-- > 0;)
   {
-    if (readyQ_ptr != nullptr)
+    out << '[';
+    for (ProcIdx p = levels[prio].front(); p != NOPROC; p = procs.link[p].next)
     {
-      delete readyQ_ptr;
+      out << procs.cold[p].id << (procs.link[p].next != NOPROC ? "," : "");
     }
+    out << ']';
   }
+  return;
 }
 
-bool PREPRIO::test_preempt(Process *currentProc, Process *proc,
-                           int curtime, multimap<int, Event *> evtQ)
-{
-  bool existPendingEvtForCrrntProc = false;
-
-  auto evts_range = evtQ.equal_range(curtime);
-  for (auto iter = evts_range.first; iter != evts_range.second; iter++)
-  {
-    if (iter->second->process->id == currentProc->id)
-    {
-      existPendingEvtForCrrntProc = true;
-      break;
-    }
-  }
-
-  if (!existPendingEvtForCrrntProc &&
-      proc->dynamicPriority > currentProc->dynamicPriority)
-  {
-    return true;
-  }
-  return false;
-}
+/////////////// MULTILEVEL QUEUE (PRIO, PREPRIO) ///////////////
+// the number of priority levels unless -s P<q>:<maxprio> or E<q>:<maxprio> says otherwise
+const size_t DEFAULT_MAXPRIO = 4;
 
-void PREPRIO::add_to_readyQ(Process *proc)
+// Storage of the priority levels of a MultiLevelQueue. MAXPRIO 0 sizes the
+// levels and the bitmap at run time (-s P<q>:<maxprio>); a compile-time
+// MAXPRIO gets a std::array and a single-word bitmap, so every level index
+// and bitmap operation is a constant-size one the compiler can unroll.
+template <size_t MAXPRIO>
+struct PrioLevels
 {
-  deque<Process *> *readyQ_ptr;
-  Bitmap *bmap_ptr;
-
-  if (proc->dynamicPriority < 0)
-  {
-    // reset and enter into expiredQ
-    proc->dynamicPriority = proc->staticPriority - 1;
-    if ((*expiredQ_ptr)[proc->dynamicPriority] == nullptr)
-    {
-      (*expiredQ_ptr)[proc->dynamicPriority] = new deque<Process *>;
-    }
-    readyQ_ptr = (*expiredQ_ptr)[proc->dynamicPriority];
-    bmap_ptr = expiredBmap_ptr;
-  }
-  else
-  {
-    // add to activeQ
-    if ((*activeQ_ptr)[proc->dynamicPriority] == nullptr)
-    {
-      (*activeQ_ptr)[proc->dynamicPriority] = new deque<Process *>;
-    }
-    readyQ_ptr = (*activeQ_ptr)[proc->dynamicPriority];
-    bmap_ptr = activeBmap_ptr;
-  }
+  array<ReadyList, MAXPRIO> levels;
+  FixedBitmap<MAXPRIO> bmap;
 
-  if (readyQ_ptr->empty())
-  {
-    bmap_ptr->setBit(static_cast<size_t>(proc->dynamicPriority));
-  }
-  readyQ_ptr->emplace_back(proc);
-  return;
-}
+  PrioLevels(const size_t) {}
+  size_t size() const { return MAXPRIO; };
+};
 
-Process *PREPRIO::get_next_process()
+template <>
+struct PrioLevels<0>
 {
-  deque<Process *> *readyQ_ptr;
-  Process *proc;
-
-  int highestPrio = activeBmap_ptr->highestPrio();
+  vector<ReadyList> levels;
+  HierBitmap bmap;
 
-  if (highestPrio == -1)
-  {
-    // activeQ is empty: swap(activeQ, expiredQ)
-    swap(activeQ_ptr, expiredQ_ptr);
-    swap(activeBmap_ptr, expiredBmap_ptr);
-  }
-
-  highestPrio = activeBmap_ptr->highestPrio();
-  if (highestPrio == -1)
-  {
-    // activeQ is still empty, there is no ready process
-    return nullptr;
-  }
-  // activeQ is not empty: pick activeQ[highest prio].front()
+  PrioLevels(const size_t maxprio) : levels(maxprio), bmap(maxprio) {}
+  size_t size() const { return levels.size(); };
+};
 
-  readyQ_ptr = (*activeQ_ptr)[highestPrio];
-  proc = readyQ_ptr->empty() ? nullptr : readyQ_ptr->front();
+// Preemption rules of a MultiLevelQueue, test() is its test_preempt()
+struct NoPreemption
+{
+  static bool test(const ProcessTable &, ProcIdx, ProcIdx, int, const SimContext &) { return false; };
+};
 
-  if (!readyQ_ptr->empty())
-  {
-    readyQ_ptr->pop_front();
-  }
-  if (readyQ_ptr->empty())
+// a ready process with a higher dynamic priority preempts the running one,
+// unless the running one has an event of its own at this time
+struct PriorityPreemption
+{
+  static bool test(const ProcessTable &procs, ProcIdx currentProc, ProcIdx proc, int curtime, const SimContext &ctx)
   {
-    activeBmap_ptr->unsetBit(static_cast<size_t>(proc->dynamicPriority));
-  }
-  return proc;
-}
-/////////////////////////////////////////////////////////
+    return !ctx.hasPendingEvent(currentProc, curtime) &&
+           procs.hot[proc].dynamicPriority > procs.hot[currentProc].dynamicPriority;
+  };
+};
 
-///////////////////// PRIORITY SCHEDULER/////////////////
-class PRIO : public Scheduler
+// An active and an expired set of FIFO levels, one per dynamic priority. A
+// process that used up its dynamic priority is reset to its static priority
+// and goes to the expired set; when the active set runs empty the two swap.
+// Another priority-based policy is a new Preemption rule or a variation of
+// add_to_readyQ() here, not another copy of the queues.
+template <class Preemption, size_t MAXPRIO = 0>
+class MultiLevelQueue final : public Scheduler
 {
 public:
-  PRIO(const size_t);
-  ~PRIO();
-  void add_to_readyQ(Process *) override;
-  Process *get_next_process() override;
-  bool test_preempt(Process *, Process *, int, multimap<int, Event *>) override { return false; };
+  MultiLevelQueue(ProcessTable &, const size_t);
+  void add_to_readyQ(ProcIdx) override;
+  ProcIdx get_next_process() override;
+  bool test_preempt(ProcIdx currentProc, ProcIdx proc, int curtime, const SimContext &ctx) override
+  {
+    return Preemption::test(procs, currentProc, proc, curtime, ctx);
+  };
+  void dump(TextWriter &) const override;
 
 private:
-  vector<deque<Process *> *> q1, q2;
-  vector<deque<Process *> *> *activeQ_ptr, *expiredQ_ptr;
-  Bitmap q1Bmap, q2Bmap;
-  Bitmap *activeBmap_ptr, *expiredBmap_ptr;
+  PrioLevels<MAXPRIO> q1, q2;
+  PrioLevels<MAXPRIO> *active, *expired;
 };
 
-PRIO::PRIO(const size_t maxprio)
-    : q1(maxprio, nullptr), q2(maxprio, nullptr),
-      q1Bmap(maxprio), q2Bmap(maxprio),
-      activeQ_ptr(&q1), expiredQ_ptr(&q2),
-      activeBmap_ptr(&q1Bmap), expiredBmap_ptr(&q2Bmap)
-{
-}
+// MAXPRIO 0: maxprio from the spec, PRIO<DEFAULT_MAXPRIO>: the default one fixed
+template <size_t MAXPRIO = 0>
+using PRIO = MultiLevelQueue<NoPreemption, MAXPRIO>;
+template <size_t MAXPRIO = 0>
+using PREPRIO = MultiLevelQueue<PriorityPreemption, MAXPRIO>;
 
-PRIO::~PRIO()
+template <class Preemption, size_t MAXPRIO>
+MultiLevelQueue<Preemption, MAXPRIO>::MultiLevelQueue(ProcessTable &procs, const size_t maxprio)
+    : Scheduler(procs), q1(maxprio), q2(maxprio), active(&q1), expired(&q2)
 {
-  for (deque<Process *> *readyQ_ptr : *activeQ_ptr)
-  {
-    if (readyQ_ptr != nullptr)
-    {
-      delete readyQ_ptr;
-    }
-  }
-  for (deque<Process *> *readyQ_ptr : *expiredQ_ptr)
-  {
-    if (readyQ_ptr != nullptr)
-    {
-      delete readyQ_ptr;
-    }
-  }
 }
 
-void PRIO::add_to_readyQ(Process *proc)
+template <class Preemption, size_t MAXPRIO>
+void MultiLevelQueue<Preemption, MAXPRIO>::add_to_readyQ(ProcIdx proc)
 {
-  deque<Process *> *readyQ_ptr;
-  Bitmap *bmap_ptr;
-
-  if (proc->dynamicPriority < 0)
+  PrioLevels<MAXPRIO> *q = active;
+  if (procs.hot[proc].dynamicPriority < 0)
   {
     // reset and enter into expiredQ
-    proc->dynamicPriority = proc->staticPriority - 1;
-    if ((*expiredQ_ptr)[proc->dynamicPriority] == nullptr)
-    {
-      (*expiredQ_ptr)[proc->dynamicPriority] = new deque<Process *>;
-    }
-    readyQ_ptr = (*expiredQ_ptr)[proc->dynamicPriority];
-    bmap_ptr = expiredBmap_ptr;
-  }
-  else
-  {
-    // add to activeQ
-    if ((*activeQ_ptr)[proc->dynamicPriority] == nullptr)
-    {
-      (*activeQ_ptr)[proc->dynamicPriority] = new deque<Process *>;
-    }
-    readyQ_ptr = (*activeQ_ptr)[proc->dynamicPriority];
-    bmap_ptr = activeBmap_ptr;
+    procs.hot[proc].dynamicPriority = procs.cold[proc].staticPriority - 1;
+    q = expired;
   }
 
-  if (readyQ_ptr->empty())
+  const size_t prio = static_cast<size_t>(procs.hot[proc].dynamicPriority);
+  if (q->levels[prio].empty())
   {
-    bmap_ptr->setBit(static_cast<size_t>(proc->dynamicPriority));
+    q->bmap.setBit(prio);
   }
-  readyQ_ptr->emplace_back(proc);
+  q->levels[prio].push_back(procs, proc);
   return;
 }
 
-Process *PRIO::get_next_process()
+template <class Preemption, size_t MAXPRIO>
+ProcIdx MultiLevelQueue<Preemption, MAXPRIO>::get_next_process()
 {
-  deque<Process *> *readyQ_ptr;
-  Process *proc;
-  int highestPrio = activeBmap_ptr->highestPrio();
-
+  int highestPrio = active->bmap.highestPrio();
   if (highestPrio == -1)
   {
     // activeQ is empty: swap(activeQ, expiredQ)
-    swap(activeQ_ptr, expiredQ_ptr);
-    swap(activeBmap_ptr, expiredBmap_ptr);
+    swap(active, expired);
+    highestPrio = active->bmap.highestPrio();
   }
-
-  highestPrio = activeBmap_ptr->highestPrio();
   if (highestPrio == -1)
   {
     // activeQ is still empty, there is no ready process
-    return nullptr;
+    return NOPROC;
   }
 
   // activeQ is not empty: pick activeQ[highest prio].front()
-  readyQ_ptr = (*activeQ_ptr)[highestPrio];
-  proc = readyQ_ptr->empty() ? nullptr : readyQ_ptr->front();
-
-  if (!readyQ_ptr->empty())
-  {
-    readyQ_ptr->pop_front();
-  }
-  if (readyQ_ptr->empty())
+  ReadyList &readyQ = active->levels[highestPrio];
+  const ProcIdx proc = readyQ.pop_front(procs);
+  if (readyQ.empty())
   {
-    activeBmap_ptr->unsetBit(static_cast<size_t>(proc->dynamicPriority));
+    active->bmap.unsetBit(static_cast<size_t>(highestPrio));
   }
   return proc;
 }
+
+template <class Preemption, size_t MAXPRIO>
+void MultiLevelQueue<Preemption, MAXPRIO>::dump(TextWriter &out) const
+{
+  out << "{ ";
+  dumpLevels(out, active->levels.data(), active->size());
+  out << " } : { ";
+  dumpLevels(out, expired->levels.data(), expired->size());
+  out << " }";
+  return;
+}
 /////////////////////////////////////////////////////////
 
 ///////////////////// Round Robin ///////////////////////
-class RR : public Scheduler
+class RR final : public Scheduler
 {
 public:
-  void add_to_readyQ(Process *) override;
-  Process *get_next_process() override;
-  bool test_preempt(Process *, Process *, int, multimap<int, Event *>) override { return false; };
+  using Scheduler::Scheduler;
+  void add_to_readyQ(ProcIdx) override;
+  ProcIdx get_next_process() override;
+  bool test_preempt(ProcIdx, ProcIdx, int, const SimContext &) override { return false; };
+  void dump(TextWriter &) const override;
 
 private:
-  deque<Process *> readyQ;
+  deque<ProcIdx> readyQ;
 };
 
-void RR::add_to_readyQ(Process *proc)
+void RR::add_to_readyQ(ProcIdx proc)
 {
-  if (proc->dynamicPriority < 0)
+  if (procs.hot[proc].dynamicPriority < 0)
   {
-    proc->dynamicPriority = proc->staticPriority - 1;
+    procs.hot[proc].dynamicPriority = procs.cold[proc].staticPriority - 1;
   }
   readyQ.emplace_back(proc);
   return;
 }
 
-Process *RR::get_next_process()
+ProcIdx RR::get_next_process()
 {
-  Process *proc = readyQ.empty() ? nullptr : readyQ.front();
+  ProcIdx proc = readyQ.empty() ? NOPROC : readyQ.front();
   if (!readyQ.empty())
   {
     readyQ.pop_front();
   }
   return proc;
 }
+
+void RR::dump(TextWriter &out) const
+{
+  out << "SCHED (" << static_cast<long long>(readyQ.size()) << "): ";
+  for (const ProcIdx proc : readyQ)
+  {
+    dumpProc(out, proc);
+  }
+  return;
+}
 /////////////////////////////////////////////////////////
 
 ///////////////////// S R T F ///////////////////////////
-class SRTF : public Scheduler
+// the ready queue of SRTF and PRESRTF, they only differ in test_preempt()
+class RemainTimeQueue : public Scheduler
 {
 public:
-  void add_to_readyQ(Process *) override;
-  Process *get_next_process() override;
-  bool test_preempt(Process *, Process *, int, multimap<int, Event *>) override { return false; };
+  using Scheduler::Scheduler;
+  void add_to_readyQ(ProcIdx) override;
+  ProcIdx get_next_process() override;
+  void dump(TextWriter &) const override;
 
-private:
-  multimap<int, Process *> readyQ;
+protected:
+  ProcHeap readyQ; // keyed by remainCpuTime, FIFO among equal keys
 };
 
-void SRTF::add_to_readyQ(Process *proc)
+class SRTF final : public RemainTimeQueue
 {
-  if (proc->dynamicPriority < 0)
+public:
+  using RemainTimeQueue::RemainTimeQueue;
+  bool test_preempt(ProcIdx, ProcIdx, int, const SimContext &) override { return false; };
+};
+
+void RemainTimeQueue::add_to_readyQ(ProcIdx proc)
+{
+  if (procs.hot[proc].dynamicPriority < 0)
   {
-    proc->dynamicPriority = proc->staticPriority - 1;
+    procs.hot[proc].dynamicPriority = procs.cold[proc].staticPriority - 1;
   }
-  readyQ.emplace(pair<int, Process *>(proc->remainCpuTime, proc));
+  readyQ.push(procs.hot[proc].remainCpuTime, proc);
   return;
 }
 
-Process *SRTF::get_next_process()
+ProcIdx RemainTimeQueue::get_next_process()
 {
-  Process *proc = readyQ.empty() ? nullptr : (*readyQ.begin()).second;
-  if (!readyQ.empty())
+  return readyQ.pop();
+}
+
+void RemainTimeQueue::dump(TextWriter &out) const
+{
+  vector<ProcIdx> ready;
+  readyQ.ordered(ready);
+  out << "SCHED (" << static_cast<long long>(ready.size()) << "): ";
+  for (const ProcIdx proc : ready)
   {
-    readyQ.extract(readyQ.begin());
+    dumpProc(out, proc);
   }
-  return proc;
+  return;
+}
+/////////////////////////////////////////////////////////
+
+////////////////// PREEMPTIVE S R T F ///////////////////
+// SRTF that preempts the running process as soon as a ready process needs
+// less CPU time than the running one has left.
+class PRESRTF final : public RemainTimeQueue
+{
+public:
+  using RemainTimeQueue::RemainTimeQueue;
+  bool test_preempt(ProcIdx, ProcIdx, int, const SimContext &) override;
+};
+
+bool PRESRTF::test_preempt(ProcIdx currentProc, ProcIdx /*proc*/,
+                           int curtime, const SimContext &ctx)
+{
+  if (readyQ.empty() || ctx.hasPendingEvent(currentProc, curtime))
+  {
+    return false;
+  }
+  // remainCpuTime of the running process is only charged when it stops running
+  const ProcHot &running = procs.hot[currentProc];
+  const int runningRemain = running.remainCpuTime - (curtime - running.state_ts);
+  return readyQ.topKey() < runningRemain;
 }
 /////////////////////////////////////////////////////////
 
 ///////////////////// L C F S ///////////////////////////
-class LCFS : public Scheduler
+class LCFS final : public Scheduler
 {
 public:
-  void add_to_readyQ(Process *) override;
-  Process *get_next_process() override;
-  bool test_preempt(Process *, Process *, int, multimap<int, Event *>) override { return false; };
+  using Scheduler::Scheduler;
+  void add_to_readyQ(ProcIdx) override;
+  ProcIdx get_next_process() override;
+  bool test_preempt(ProcIdx, ProcIdx, int, const SimContext &) override { return false; };
+  void dump(TextWriter &) const override;
 
 private:
-  deque<Process *> readyQ;
+  deque<ProcIdx> readyQ;
 };
 
-void LCFS::add_to_readyQ(Process *proc)
+void LCFS::add_to_readyQ(ProcIdx proc)
 {
-  if (proc->dynamicPriority < 0)
+  if (procs.hot[proc].dynamicPriority < 0)
   {
-    proc->dynamicPriority = proc->staticPriority - 1;
+    procs.hot[proc].dynamicPriority = procs.cold[proc].staticPriority - 1;
   }
   readyQ.emplace_back(proc);
   return;
 }
 
-Process *LCFS::get_next_process()
+ProcIdx LCFS::get_next_process()
 {
-  Process *proc = readyQ.empty() ? nullptr : readyQ.back();
+  ProcIdx proc = readyQ.empty() ? NOPROC : readyQ.back();
   if (!readyQ.empty())
   {
     readyQ.pop_back();
   }
   return proc;
 }
+
+void LCFS::dump(TextWriter &out) const
+{
+  // picked from the back
+  out << "SCHED (" << static_cast<long long>(readyQ.size()) << "): ";
+  for (auto it = readyQ.rbegin(); it != readyQ.rend(); ++it)
+  {
+    dumpProc(out, *it);
+  }
+  return;
+}
 /////////////////////////////////////////////////////////
 
 ///////////////////// F C F S ///////////////////////////
-class FCFS : public Scheduler
+class FCFS final : public Scheduler
 {
 public:
-  void add_to_readyQ(Process *) override;
-  Process *get_next_process() override;
-  bool test_preempt(Process *, Process *, int, multimap<int, Event *>) override { return false; };
+  using Scheduler::Scheduler;
+  void add_to_readyQ(ProcIdx) override;
+  ProcIdx get_next_process() override;
+  bool test_preempt(ProcIdx, ProcIdx, int, const SimContext &) override { return false; };
+  void dump(TextWriter &) const override;
 
 private:
-  deque<Process *> readyQ;
+  deque<ProcIdx> readyQ;
 };
 
-void FCFS::add_to_readyQ(Process *proc)
+void FCFS::add_to_readyQ(ProcIdx proc)
 {
-  if (proc->dynamicPriority < 0)
+  if (procs.hot[proc].dynamicPriority < 0)
   {
-    proc->dynamicPriority = proc->staticPriority - 1;
+    procs.hot[proc].dynamicPriority = procs.cold[proc].staticPriority - 1;
   }
   readyQ.emplace_back(proc);
   return;
 }
 
-Process *FCFS::get_next_process()
+ProcIdx FCFS::get_next_process()
 {
-  Process *proc = readyQ.empty() ? nullptr : readyQ.front();
+  ProcIdx proc = readyQ.empty() ? NOPROC : readyQ.front();
   if (!readyQ.empty())
   {
     readyQ.pop_front();
   }
   return proc;
 }
+
+void FCFS::dump(TextWriter &out) const
+{
+  out << "SCHED (" << static_cast<long long>(readyQ.size()) << "): ";
+  for (const ProcIdx proc : readyQ)
+  {
+    dumpProc(out, proc);
+  }
+  return;
+}
 /////////////////////////////////////////////////////////
 
 #endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#ifndef SIMCONTEXT_H
+#define SIMCONTEXT_H
+
+using namespace std;
+
+#include "Process.h"
+#include "Event.h"
+#include "EventQueue.h"
+
+// Read-only view of the simulation state handed to the schedulers,
+// so they can query the event queue without copying it.
+class SimContext
+{
+public:
+  SimContext(const EventQueue &);
+  bool hasPendingEvent(const ProcIdx, const int) const;
+
+private:
+  const EventQueue &evtQ;
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+SimContext::SimContext(const EventQueue &evtQ)
+    : evtQ(evtQ)
+{
+}
+
+// does the process have a pending event at timeStamp?
+// a process has at most one pending event, so this is a single index lookup
+bool SimContext::hasPendingEvent(const ProcIdx proc, const int timeStamp) const
+{
+  const Event *evt = evtQ.pending(proc);
+  return evt != nullptr && evt->timeStamp == timeStamp;
+}
+
+#endif
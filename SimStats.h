@@ -0,0 +1,198 @@
+#ifndef SIMSTATS_H
+#define SIMSTATS_H
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+using namespace std;
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "Process.h"
+#include "Event.h"
+#include "EventQueue.h"
+#include "Scheduler.h"
+
+// Hot-path counters and timings of one run (--stats), printed to the run's
+// error stream after the summary. Off, Simulation() tests one pointer per
+// event and the queue and the scheduler are not wrapped at all.
+//
+// Times are ticks: TSC cycles on x86, steady_clock nanoseconds elsewhere.
+// A transition's ticks include the scheduler and queue calls it makes.
+uint64_t readTicks();
+const char *const TICKS_UNIT =
+#if defined(__x86_64__) || defined(__i386__)
+    "TSC cycles";
+#else
+    "ns";
+#endif
+
+struct OpStats
+{
+  uint64_t calls = 0, ticks = 0;
+};
+
+struct SimStats
+{
+  static constexpr int NUM_OF_TRANS = 5;
+
+  OpStats transitions[NUM_OF_TRANS]; // indexed by Trans
+  OpStats addToReady, getNext, testPreempt;
+  uint64_t preemptions = 0; // test_preempt() calls that returned true
+  uint64_t pushes = 0, pushFirsts = 0, cancels = 0, pops = 0;
+  double seconds = 0; // wall time of the event loop
+
+  void print(ostream &, const string &) const;
+};
+
+// counts the event queue operations of the run, forwards everything else
+class EventQueueCounter : public EventQueue
+{
+public:
+  EventQueueCounter(EventQueue &inner, SimStats &stats) : inner(inner), stats(stats){};
+
+  bool empty() const override { return inner.empty(); };
+  size_t size() const override { return inner.size(); };
+  int nextTimeStamp() const override { return inner.nextTimeStamp(); };
+
+  void push(const int, const ProcIdx, const Trans) override;
+  void pushFirst(const int, const ProcIdx, const Trans) override;
+  Event pop() override;
+  bool cancel(const ProcIdx) override;
+  const Event *pending(const ProcIdx proc) const override { return inner.pending(proc); };
+  void snapshot(vector<Event> &events) const override { inner.snapshot(events); };
+
+private:
+  EventQueue &inner;
+  SimStats &stats;
+};
+
+// counts and times the scheduler calls of the run
+class SchedulerTimer : public Scheduler
+{
+public:
+  SchedulerTimer(Scheduler &, ProcessTable &, SimStats &);
+
+  void add_to_readyQ(ProcIdx) override;
+  ProcIdx get_next_process() override;
+  bool test_preempt(ProcIdx, ProcIdx, int, const SimContext &) override;
+  void dump(TextWriter &os) const override { inner.dump(os); };
+
+private:
+  Scheduler &inner;
+  SimStats &stats;
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+uint64_t readTicks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static void printOp(ostream &os, const char *name, const OpStats &op)
+{
+  char line[128];
+  snprintf(line, sizeof(line), "  %-18s %12llu %16llu %12.1lf\n", name,
+           static_cast<unsigned long long>(op.calls), static_cast<unsigned long long>(op.ticks),
+           op.calls == 0 ? 0.0 : static_cast<double>(op.ticks) / op.calls);
+  os << line;
+  return;
+}
+
+void SimStats::print(ostream &os, const string &schedspec) const
+{
+  uint64_t events = 0;
+  for (const OpStats &op : transitions)
+  {
+    events += op.calls;
+  }
+  char line[160];
+  snprintf(line, sizeof(line), "Stats %s: %llu events in %.3lf s (%.2lf M events/s), ticks are %s\n",
+           schedspec.c_str(), static_cast<unsigned long long>(events), seconds,
+           seconds > 0 ? events / seconds / 1e6 : 0.0, TICKS_UNIT);
+  os << line;
+  snprintf(line, sizeof(line), "  %-18s %12s %16s %12s\n", "operation", "calls", "ticks", "ticks/call");
+  os << line;
+  for (int t = 0; t < NUM_OF_TRANS; t++)
+  {
+    printOp(os, enumToString(static_cast<Trans>(t)).c_str(), transitions[t]);
+  }
+  printOp(os, "add_to_readyQ", addToReady);
+  printOp(os, "get_next_process", getNext);
+  printOp(os, "test_preempt", testPreempt);
+  snprintf(line, sizeof(line), "  preemptions=%llu push=%llu pushFirst=%llu cancel=%llu pop=%llu\n",
+           static_cast<unsigned long long>(preemptions), static_cast<unsigned long long>(pushes),
+           static_cast<unsigned long long>(pushFirsts), static_cast<unsigned long long>(cancels),
+           static_cast<unsigned long long>(pops));
+  os << line;
+  return;
+}
+
+void EventQueueCounter::push(const int ts, const ProcIdx proc, const Trans trans)
+{
+  stats.pushes++;
+  inner.push(ts, proc, trans);
+  return;
+}
+
+void EventQueueCounter::pushFirst(const int ts, const ProcIdx proc, const Trans trans)
+{
+  stats.pushFirsts++;
+  inner.pushFirst(ts, proc, trans);
+  return;
+}
+
+Event EventQueueCounter::pop()
+{
+  stats.pops++;
+  return inner.pop();
+}
+
+bool EventQueueCounter::cancel(const ProcIdx proc)
+{
+  const bool cancelled = inner.cancel(proc);
+  stats.cancels += cancelled ? 1 : 0; // only events that were actually pending
+  return cancelled;
+}
+
+SchedulerTimer::SchedulerTimer(Scheduler &inner, ProcessTable &procs, SimStats &stats)
+    : Scheduler(procs), inner(inner), stats(stats)
+{
+}
+
+void SchedulerTimer::add_to_readyQ(ProcIdx proc)
+{
+  const uint64_t start = readTicks();
+  inner.add_to_readyQ(proc);
+  stats.addToReady.ticks += readTicks() - start;
+  stats.addToReady.calls++;
+  return;
+}
+
+ProcIdx SchedulerTimer::get_next_process()
+{
+  const uint64_t start = readTicks();
+  const ProcIdx proc = inner.get_next_process();
+  stats.getNext.ticks += readTicks() - start;
+  stats.getNext.calls++;
+  return proc;
+}
+
+bool SchedulerTimer::test_preempt(ProcIdx currentProc, ProcIdx proc, int curtime, const SimContext &ctx)
+{
+  const uint64_t start = readTicks();
+  const bool preempt = inner.test_preempt(currentProc, proc, curtime, ctx);
+  stats.testPreempt.ticks += readTicks() - start;
+  stats.testPreempt.calls++;
+  stats.preemptions += preempt ? 1 : 0;
+  return preempt;
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef TEXTWRITER_H
+#define TEXTWRITER_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+using namespace std;
+
+// Buffered text output for the big outputs (-v lines, the report, tracedump).
+// Integers are formatted by hand into a large user-space buffer that goes to
+// the underlying ostream in blocks of capacity bytes, instead of iostream
+// formatting plus a flush (endl) per line. The text is the same as what
+// "os << value" (with setw/setfill for pad()) would print.
+class TextWriter
+{
+public:
+  TextWriter(ostream &, const size_t = 1 << 20);
+  TextWriter(const TextWriter &) = delete;
+  TextWriter &operator=(const TextWriter &) = delete;
+  ~TextWriter() { flush(); };
+
+  TextWriter &operator<<(const char);
+  TextWriter &operator<<(const char *);
+  TextWriter &operator<<(const string &);
+  TextWriter &operator<<(const long long);
+  TextWriter &operator<<(const int value) { return *this << static_cast<long long>(value); };
+  TextWriter &operator<<(const unsigned value) { return *this << static_cast<long long>(value); };
+  TextWriter &pad(const long long, const int, const char = ' '); // like os << setfill(fill) << setw(width) << value
+  TextWriter &write(const char *, const size_t);
+  void flush();
+
+private:
+  ostream &os;
+  vector<char> buf;
+  size_t len;
+
+  void reserve(const size_t n)
+  {
+    if (len + n > buf.size())
+    {
+      flush();
+    }
+  };
+  static size_t format(char *, long long); // digits at the end of a 20-byte scratch, returns their count
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+TextWriter::TextWriter(ostream &os, const size_t capacity)
+    : os(os), buf(max<size_t>(capacity, 64)), len(0)
+{
+}
+
+void TextWriter::flush()
+{
+  if (len > 0)
+  {
+    os.write(buf.data(), len);
+    len = 0;
+  }
+  return;
+}
+
+TextWriter &TextWriter::write(const char *s, const size_t n)
+{
+  if (n > buf.size())
+  {
+    flush();
+    os.write(s, n);
+    return *this;
+  }
+  reserve(n);
+  memcpy(buf.data() + len, s, n);
+  len += n;
+  return *this;
+}
+
+TextWriter &TextWriter::operator<<(const char c)
+{
+  reserve(1);
+  buf[len++] = c;
+  return *this;
+}
+
+TextWriter &TextWriter::operator<<(const char *s)
+{
+  return write(s, strlen(s));
+}
+
+TextWriter &TextWriter::operator<<(const string &s)
+{
+  return write(s.data(), s.size());
+}
+
+size_t TextWriter::format(char *end, long long value)
+{
+  static const char pairs[] =
+      "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+      "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+      "8081828384858687888990919293949596979899";
+  const bool negative = value < 0;
+  unsigned long long v = negative ? 0ULL - static_cast<unsigned long long>(value) : value;
+  char *p = end;
+  // two digits per step
+  while (v >= 100)
+  {
+    const unsigned d = static_cast<unsigned>(v % 100) * 2;
+    v /= 100;
+    *--p = pairs[d + 1];
+    *--p = pairs[d];
+  }
+  if (v >= 10)
+  {
+    *--p = pairs[v * 2 + 1];
+    *--p = pairs[v * 2];
+  }
+  else
+  {
+    *--p = static_cast<char>('0' + v);
+  }
+  if (negative)
+  {
+    *--p = '-';
+  }
+  return end - p;
+}
+
+TextWriter &TextWriter::operator<<(const long long value)
+{
+  char scratch[20];
+  const size_t n = format(scratch + sizeof(scratch), value);
+  reserve(n);
+  memcpy(buf.data() + len, scratch + sizeof(scratch) - n, n);
+  len += n;
+  return *this;
+}
+
+TextWriter &TextWriter::pad(const long long value, const int width, const char fill)
+{
+  char scratch[20];
+  const size_t n = format(scratch + sizeof(scratch), value);
+  const size_t fillCount = (static_cast<size_t>(width) > n) ? width - n : 0;
+  reserve(fillCount + n);
+  memset(buf.data() + len, fill, fillCount);
+  memcpy(buf.data() + len + fillCount, scratch + sizeof(scratch) - n, n);
+  len += fillCount + n;
+  return *this;
+}
+
+#endif
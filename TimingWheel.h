@@ -0,0 +1,361 @@
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <map>
+#include <vector>
+#include <cstdint>
+using namespace std;
+
+#include "Process.h"
+#include "Event.h"
+#include "EventQueue.h"
+#include "Bitmap.h" // BITS_PER_ULL
+
+///////////////////// TIMING WHEEL BACKEND //////////////
+// Event queue for integer timeStamps that are never earlier than the last
+// popped one (true for the simulation: every event is scheduled at or after
+// CURRENT_TIME). The wheel has numOfSlots (a power of 2) slots covering
+// [base, base + numOfSlots), where base is the timeStamp of the last popped
+// event, so every slot holds the events of exactly one timeStamp, as an
+// intrusive FIFO list. A two-level occupancy bitmap finds the next non-empty
+// slot in O(1). Events further ahead than the wheel go to a small overflow
+// multimap and move into the wheel once base comes close enough; they always
+// move before anything else can be pushed for their timeStamp, so the FIFO
+// order is the same as with MultimapEventQueue.
+// The list nodes hold the events inline in one contiguous vector, recycled
+// through a free list, so popping an event is a slot lookup and a copy.
+class WheelEventQueue : public EventQueue
+{
+public:
+  WheelEventQueue(const size_t = 4096);
+
+  bool empty() const override { return count == 0; };
+  size_t size() const override { return count; };
+  int nextTimeStamp() const override;
+
+  void push(const int, const ProcIdx, const Trans) override;
+  void pushFirst(const int, const ProcIdx, const Trans) override;
+  Event pop() override;
+  bool cancel(const ProcIdx) override;
+  const Event *pending(const ProcIdx) const override;
+  void snapshot(vector<Event> &) const override;
+
+private:
+  static constexpr uint32_t NIL = UINT32_MAX;
+  static constexpr uint32_t FAR = UINT32_MAX - 1; // prev of a node in the overflow map
+  struct Node
+  {
+    Event evt;
+    uint32_t prev, next;
+  };
+
+  const size_t numOfSlots, mask;
+  int base;
+  size_t count, wheelCount;
+  vector<uint32_t> head, tail;                  // per slot
+  vector<unsigned long long> occupied, summary; // bit per slot, bit per occupied word
+  vector<Node> nodes;
+  vector<uint32_t> freeNodes;
+  multimap<int, uint32_t> overflow;
+  vector<uint32_t> index; // ProcIdx -> node, NIL if no pending event
+
+  static size_t roundUp(size_t);
+  uint32_t newNode(const Event &);
+  void add(const Event &, const bool);
+  void linkBack(const size_t, const uint32_t);
+  void linkFront(const size_t, const uint32_t);
+  void unlink(const size_t, const uint32_t);
+  long findFrom(const size_t) const;
+  size_t firstSlot() const;
+  void migrate();
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+size_t WheelEventQueue::roundUp(size_t n)
+{
+  size_t p = 64;
+  while (p < n)
+  {
+    p <<= 1;
+  }
+  return p;
+}
+
+WheelEventQueue::WheelEventQueue(const size_t slots)
+    : numOfSlots(roundUp(slots)), mask(numOfSlots - 1), base(0), count(0), wheelCount(0),
+      head(numOfSlots, NIL), tail(numOfSlots, NIL),
+      occupied(numOfSlots / BITS_PER_ULL, 0),
+      summary((numOfSlots / BITS_PER_ULL + BITS_PER_ULL - 1) / BITS_PER_ULL, 0)
+{
+}
+
+uint32_t WheelEventQueue::newNode(const Event &evt)
+{
+  uint32_t n;
+  if (freeNodes.empty())
+  {
+    n = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+  }
+  else
+  {
+    n = freeNodes.back();
+    freeNodes.pop_back();
+  }
+  nodes[n].evt = evt;
+  nodes[n].prev = nodes[n].next = NIL;
+  return n;
+}
+
+void WheelEventQueue::linkBack(const size_t s, const uint32_t n)
+{
+  nodes[n].prev = tail[s];
+  nodes[n].next = NIL;
+  if (tail[s] == NIL)
+  {
+    head[s] = n;
+    occupied[s / BITS_PER_ULL] |= 1ULL << (s % BITS_PER_ULL);
+    summary[s / BITS_PER_ULL / BITS_PER_ULL] |= 1ULL << (s / BITS_PER_ULL % BITS_PER_ULL);
+  }
+  else
+  {
+    nodes[tail[s]].next = n;
+  }
+  tail[s] = n;
+  wheelCount++;
+  return;
+}
+
+void WheelEventQueue::linkFront(const size_t s, const uint32_t n)
+{
+  if (head[s] == NIL)
+  {
+    linkBack(s, n);
+    return;
+  }
+  nodes[n].prev = NIL;
+  nodes[n].next = head[s];
+  nodes[head[s]].prev = n;
+  head[s] = n;
+  wheelCount++;
+  return;
+}
+
+void WheelEventQueue::unlink(const size_t s, const uint32_t n)
+{
+  const Node &node = nodes[n];
+  if (node.prev == NIL)
+  {
+    head[s] = node.next;
+  }
+  else
+  {
+    nodes[node.prev].next = node.next;
+  }
+  if (node.next == NIL)
+  {
+    tail[s] = node.prev;
+  }
+  else
+  {
+    nodes[node.next].prev = node.prev;
+  }
+  if (head[s] == NIL)
+  {
+    unsigned long long &word = occupied[s / BITS_PER_ULL];
+    word &= ~(1ULL << (s % BITS_PER_ULL));
+    if (word == 0)
+    {
+      summary[s / BITS_PER_ULL / BITS_PER_ULL] &= ~(1ULL << (s / BITS_PER_ULL % BITS_PER_ULL));
+    }
+  }
+  wheelCount--;
+  return;
+}
+
+// first non-empty slot at or after s, -1 if none
+long WheelEventQueue::findFrom(const size_t s) const
+{
+  size_t w = s / BITS_PER_ULL;
+  unsigned long long bits = occupied[w] & (~0ULL << (s % BITS_PER_ULL));
+  if (bits != 0)
+  {
+    return w * BITS_PER_ULL + __builtin_ctzll(bits);
+  }
+  // next non-empty word after w, found through the summary
+  w++;
+  if (w >= occupied.size())
+  {
+    return -1;
+  }
+  size_t sw = w / BITS_PER_ULL;
+  unsigned long long sbits = summary[sw] & (~0ULL << (w % BITS_PER_ULL));
+  while (sbits == 0)
+  {
+    if (++sw >= summary.size())
+    {
+      return -1;
+    }
+    sbits = summary[sw];
+  }
+  w = sw * BITS_PER_ULL + __builtin_ctzll(sbits);
+  return w * BITS_PER_ULL + __builtin_ctzll(occupied[w]);
+}
+
+// slot of the earliest event in the wheel, the wheel must not be empty
+size_t WheelEventQueue::firstSlot() const
+{
+  // slots from base's slot up to the end hold earlier timeStamps than the wrapped-around ones
+  long s = findFrom(static_cast<size_t>(base) & mask);
+  if (s < 0)
+  {
+    s = findFrom(0);
+  }
+  return static_cast<size_t>(s);
+}
+
+int WheelEventQueue::nextTimeStamp() const
+{
+  if (wheelCount > 0)
+  {
+    return nodes[head[firstSlot()]].evt.timeStamp;
+  }
+  return overflow.begin()->first;
+}
+
+void WheelEventQueue::add(const Event &evt, const bool first)
+{
+  const uint32_t n = newNode(evt);
+  const long long ahead = static_cast<long long>(evt.timeStamp) - base;
+  if (ahead < static_cast<long long>(numOfSlots))
+  {
+    const size_t s = static_cast<size_t>(evt.timeStamp) & mask;
+    first ? linkFront(s, n) : linkBack(s, n);
+  }
+  else
+  {
+    nodes[n].prev = FAR;
+    first ? overflow.emplace_hint(overflow.lower_bound(evt.timeStamp), evt.timeStamp, n)
+          : overflow.emplace(evt.timeStamp, n);
+  }
+
+  if (evt.process >= index.size())
+  {
+    index.resize(evt.process + 1, NIL);
+  }
+  index[evt.process] = n;
+  count++;
+  return;
+}
+
+void WheelEventQueue::push(const int ts, const ProcIdx proc, const Trans trans)
+{
+  add(make(ts, proc, trans), false);
+  return;
+}
+
+void WheelEventQueue::pushFirst(const int ts, const ProcIdx proc, const Trans trans)
+{
+  add(make(ts, proc, trans), true);
+  return;
+}
+
+// move overflow events that are now within the wheel's reach, in their order
+void WheelEventQueue::migrate()
+{
+  while (!overflow.empty() &&
+         static_cast<long long>(overflow.begin()->first) - base < static_cast<long long>(numOfSlots))
+  {
+    const uint32_t n = overflow.begin()->second;
+    overflow.erase(overflow.begin());
+    linkBack(static_cast<size_t>(nodes[n].evt.timeStamp) & mask, n);
+  }
+  return;
+}
+
+Event WheelEventQueue::pop()
+{
+  uint32_t n;
+  if (wheelCount > 0)
+  {
+    const size_t s = firstSlot();
+    n = head[s];
+    unlink(s, n);
+  }
+  else
+  {
+    n = overflow.begin()->second;
+    overflow.erase(overflow.begin());
+  }
+
+  const Event evt = nodes[n].evt;
+  if (index[evt.process] == n)
+  {
+    index[evt.process] = NIL;
+  }
+  freeNodes.emplace_back(n);
+  count--;
+
+  base = evt.timeStamp;
+  migrate();
+  return evt;
+}
+
+bool WheelEventQueue::cancel(const ProcIdx proc)
+{
+  if (proc >= index.size() || index[proc] == NIL)
+  {
+    return false;
+  }
+  const uint32_t n = index[proc];
+  const int ts = nodes[n].evt.timeStamp;
+  if (nodes[n].prev == FAR)
+  {
+    // far events are few, a scan of their timeStamp's range is cheap
+    auto it = overflow.lower_bound(ts);
+    while (it->second != n)
+    {
+      ++it;
+    }
+    overflow.erase(it);
+  }
+  else
+  {
+    unlink(static_cast<size_t>(ts) & mask, n);
+  }
+  freeNodes.emplace_back(n);
+  index[proc] = NIL;
+  count--;
+  return true;
+}
+
+const Event *WheelEventQueue::pending(const ProcIdx proc) const
+{
+  if (proc >= index.size() || index[proc] == NIL)
+  {
+    return nullptr;
+  }
+  return &nodes[index[proc]].evt;
+}
+
+void WheelEventQueue::snapshot(vector<Event> &events) const
+{
+  events.clear();
+  // slots in timeStamp order start at base's slot, then the overflow map
+  for (size_t k = 0; k < numOfSlots; k++)
+  {
+    const size_t s = (static_cast<size_t>(base) + k) & mask;
+    for (uint32_t n = head[s]; n != NIL; n = nodes[n].next)
+    {
+      events.emplace_back(nodes[n].evt);
+    }
+  }
+  for (const auto &entry : overflow)
+  {
+    events.emplace_back(nodes[entry.second].evt);
+  }
+  return;
+}
+/////////////////////////////////////////////////////////
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+using namespace std;
+
+#include "Process.h"
+#include "Event.h"
+#include "MappedFile.h"
+
+// Binary trace file (DES -b <file>, decoded by tracedump):
+//   header:  "DESTRACE", uint32 recordSize
+//   records: one TraceRecord per logged transition, in simulation order
+//   text:    the rest of the -v output (scheduler name, report, SUM line)
+//   footer:  uint64 #records, uint64 text length, "DESTEND1"
+// A trace without footer (the run died) still decodes up to its last
+// complete record.
+const char TRACE_MAGIC[8] = {'D', 'E', 'S', 'T', 'R', 'A', 'C', 'E'};
+const char TRACE_END_MAGIC[8] = {'D', 'E', 'S', 'T', 'E', 'N', 'D', '1'};
+
+struct TraceFooter
+{
+  uint64_t records, textLength;
+  char magic[8];
+};
+
+// Writes the trace without slowing down the simulation: log() copies a
+// record into a single-producer single-consumer ring buffer and a background
+// thread drains the ring to the file in large blocks. When the ring is full
+// log() waits for the writer, so no record is ever dropped.
+class TraceWriter
+{
+public:
+  TraceWriter(const string &, const size_t = 1 << 16);
+  TraceWriter(const TraceWriter &) = delete;
+  TraceWriter &operator=(const TraceWriter &) = delete;
+  ~TraceWriter();
+
+  bool is_open() const { return file.is_open(); };
+  void log(const Event &, const ProcessTable &);
+  ostream &text(); // stops the writer after the last record; the rest of the output goes here
+
+private:
+  ofstream file;
+  vector<TraceRecord> ring;
+  const size_t mask;
+  alignas(64) atomic<uint64_t> head; // next record to fill, owned by log()
+  alignas(64) atomic<uint64_t> tail; // next record to write, owned by the writer thread
+  atomic<bool> stopping;
+  thread writer;
+  streampos textStart;
+
+  static size_t roundUp(size_t);
+  void drain();
+};
+
+// TODO: should move the implementation to ~.cpp after making the makefile that compiles ~.cpp
+size_t TraceWriter::roundUp(size_t n)
+{
+  size_t p = 1;
+  while (p < n)
+  {
+    p <<= 1;
+  }
+  return p;
+}
+
+TraceWriter::TraceWriter(const string &path, const size_t capacity)
+    : file(path, ios::binary | ios::trunc), ring(roundUp(capacity)), mask(ring.size() - 1),
+      head(0), tail(0), stopping(false), textStart(-1)
+{
+  if (!file.is_open())
+  {
+    return;
+  }
+  const uint32_t recordSize = sizeof(TraceRecord);
+  file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+  file.write(reinterpret_cast<const char *>(&recordSize), sizeof(recordSize));
+  writer = thread(&TraceWriter::drain, this);
+}
+
+TraceWriter::~TraceWriter()
+{
+  if (!is_open())
+  {
+    return;
+  }
+  text();
+  TraceFooter footer = {head.load(), static_cast<uint64_t>(file.tellp() - textStart), {}};
+  memcpy(footer.magic, TRACE_END_MAGIC, sizeof(footer.magic));
+  file.write(reinterpret_cast<const char *>(&footer), sizeof(footer));
+}
+
+void TraceWriter::log(const Event &evt, const ProcessTable &procs)
+{
+  const uint64_t h = head.load(memory_order_relaxed);
+  while (h - tail.load(memory_order_acquire) == ring.size())
+  {
+    this_thread::yield(); // ring is full, let the writer catch up
+  }
+  ring[h & mask] = evt.record(procs);
+  head.store(h + 1, memory_order_release);
+  return;
+}
+
+void TraceWriter::drain()
+{
+  for (;;)
+  {
+    // read stopping before head: once it is set, head is final
+    const bool last = stopping.load(memory_order_acquire);
+    const uint64_t t = tail.load(memory_order_relaxed);
+    const uint64_t h = head.load(memory_order_acquire);
+    if (t == h)
+    {
+      if (last)
+      {
+        return;
+      }
+      this_thread::sleep_for(chrono::microseconds(200));
+      continue;
+    }
+    // write the filled part up to the end of the ring in one go
+    const size_t from = t & mask;
+    const size_t n = min<uint64_t>(h - t, ring.size() - from);
+    file.write(reinterpret_cast<const char *>(&ring[from]), n * sizeof(TraceRecord));
+    tail.store(t + n, memory_order_release);
+  }
+}
+
+ostream &TraceWriter::text()
+{
+  if (writer.joinable())
+  {
+    stopping.store(true, memory_order_release);
+    writer.join();
+    textStart = file.tellp();
+  }
+  return file;
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef BENCH_WORKLOAD_H
+#define BENCH_WORKLOAD_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <unistd.h>
+using namespace std;
+
+// What the benches that run the simulator share: where their generated
+// files go, the rand file they draw bursts from, and a sink for the report.
+
+// "<dir>/DESbench.<pid>", dir is the argument, else $TMPDIR, else /tmp;
+// the benches add a suffix per file
+string benchTmpPath(const char *dir)
+{
+  if (dir == nullptr || *dir == '\0')
+  {
+    dir = getenv("TMPDIR");
+  }
+  return string((dir != nullptr && *dir != '\0') ? dir : "/tmp") + "/DESbench." + to_string(getpid());
+}
+
+// 40000 random numbers in the text format of the lab's rand file, always the same
+bool writeRandFile(const string &path)
+{
+  mt19937 gen(13);
+  uniform_int_distribution<int> value(0, numeric_limits<int>::max());
+  FILE *f = fopen(path.c_str(), "w");
+  if (f == nullptr)
+  {
+    return false;
+  }
+  const int amount = 40000;
+  fprintf(f, "%d\n", amount);
+  for (int i = 0; i < amount; i++)
+  {
+    fprintf(f, "%d\n", value(gen));
+  }
+  return fclose(f) == 0;
+}
+
+// discards the simulator's report
+class NullBuf : public streambuf
+{
+protected:
+  int overflow(int c) override { return c; }
+  streamsize xsputn(const char *, streamsize n) override { return n; }
+};
+
+#endif
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+using namespace std;
+
+#include "../Bitmap.h"
+
+// Micro-benchmark: Bitmap (flat scan) vs HierBitmap vs FixedBitmap<64>.
+// The op stream mimics a ready queue: set a random priority, ask for the
+// highest one, unset it. A mostly-empty bitmap with the set bits in the low
+// priorities is the worst case for the flat scan.
+// usage: bench/bitmap [#ops]
+
+struct Op
+{
+  size_t prio;
+};
+
+template <class BMAP>
+double run(BMAP &bmap, const vector<Op> &ops, long long &checksum)
+{
+  auto start = chrono::steady_clock::now();
+  for (const Op &op : ops)
+  {
+    bmap.setBit(op.prio);
+    int top = bmap.highestPrio();
+    checksum += top;
+    bmap.unsetBit(static_cast<size_t>(top));
+  }
+  auto stop = chrono::steady_clock::now();
+  return chrono::duration<double, nano>(stop - start).count() / ops.size();
+}
+
+int main(int argc, char **argv)
+{
+  const size_t numOfOps = (argc > 1) ? atol(argv[1]) : 2000000;
+  const size_t maxprios[] = {4, 64, 1024, 4096, 65536};
+
+  cout << "maxprio      Bitmap(ns/op)  HierBitmap(ns/op)  FixedBitmap<64>(ns/op)" << endl;
+  for (size_t maxprio : maxprios)
+  {
+    mt19937 gen(42);
+    uniform_int_distribution<size_t> dist(0, min<size_t>(maxprio, 16) - 1);
+    vector<Op> ops(numOfOps);
+    for (Op &op : ops)
+    {
+      op.prio = dist(gen);
+    }
+
+    long long flatSum = 0, hierSum = 0, fixedSum = 0;
+    Bitmap flat(maxprio);
+    HierBitmap hier(maxprio);
+    double flatNs = run(flat, ops, flatSum);
+    double hierNs = run(hier, ops, hierSum);
+
+    cout << setw(7) << maxprio << fixed << setprecision(2)
+         << setw(17) << flatNs << setw(19) << hierNs;
+    if (maxprio <= 64)
+    {
+      FixedBitmap<64> fixedBmap;
+      cout << setw(24) << run(fixedBmap, ops, fixedSum);
+    }
+    else
+    {
+      fixedSum = flatSum;
+      cout << setw(24) << "-";
+    }
+    cout << endl;
+
+    if (flatSum != hierSum || flatSum != fixedSum)
+    {
+      cerr << "Error: bitmaps disagree for maxprio " << maxprio << endl;
+      return 1;
+    }
+  }
+  return 0;
+}
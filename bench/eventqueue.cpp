@@ -0,0 +1,72 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <random>
+using namespace std;
+
+#include "../EventQueue.h"
+#include "../TimingWheel.h"
+
+// Event queue backend benchmark ("hold" model): numOfProcs processes each
+// keep one pending event; every step pops the earliest event and schedules
+// that process again 1..maxDelay ticks later, like a burst or an IO
+// completion. Every 8th step also replaces the pending event of another
+// process, like a preemption does.
+// usage: bench/eventqueue [#events per run] [maxDelay]
+
+double run(EventQueue &evtQ, const size_t numOfProcs, const size_t numOfEvents, const int maxDelay,
+           unsigned long long &checksum)
+{
+  mt19937 gen(7);
+  uniform_int_distribution<int> delay(1, maxDelay);
+  uniform_int_distribution<ProcIdx> anyProc(0, numOfProcs - 1);
+
+  for (ProcIdx p = 0; p < numOfProcs; p++)
+  {
+    evtQ.push(delay(gen), p, Trans::TRANS_TO_READY);
+  }
+
+  auto start = chrono::steady_clock::now();
+  for (size_t i = 0; i < numOfEvents; i++)
+  {
+    const Event evt = evtQ.pop();
+    const int now = evt.timeStamp;
+    const ProcIdx proc = evt.process;
+    checksum = checksum * 31 + proc;
+
+    evtQ.push(now + delay(gen), proc, Trans::TRANS_TO_BLOCKED);
+    if ((i & 7) == 0)
+    {
+      evtQ.reschedule(now + delay(gen), anyProc(gen), Trans::TRANS_TO_PREEMPT);
+    }
+  }
+  auto stop = chrono::steady_clock::now();
+  return numOfEvents / chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char **argv)
+{
+  const size_t numOfEvents = (argc > 1) ? atol(argv[1]) : 5000000;
+  const int maxDelay = (argc > 2) ? atoi(argv[2]) : 500;
+  const size_t procCounts[] = {1000, 10000, 100000, 1000000};
+
+  cout << "#procs      multimap(Mevents/s)  wheel(Mevents/s)" << endl;
+  for (size_t numOfProcs : procCounts)
+  {
+    unsigned long long mmSum = 0, wheelSum = 0;
+    MultimapEventQueue mm;
+    WheelEventQueue wheel;
+    double mmRate = run(mm, numOfProcs, numOfEvents, maxDelay, mmSum);
+    double wheelRate = run(wheel, numOfProcs, numOfEvents, maxDelay, wheelSum);
+
+    cout << setw(7) << numOfProcs << fixed << setprecision(2)
+         << setw(23) << mmRate / 1e6 << setw(18) << wheelRate / 1e6 << endl;
+    if (mmSum != wheelSum)
+    {
+      cerr << "Error: backends pop events in a different order for " << numOfProcs << " processes" << endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+
+#include "Workload.h"
+
+// the simulator itself, without its command line
+#define main desMain
+#include "../DES.cpp"
+#undef main
+
+// Event loop on the concrete policy vs. on the virtual Scheduler interface:
+// the same runs through PolicySimulation<FCFS> (what Simulation() picks) and
+// PolicySimulation<FCFS, Scheduler> (what it picks when wrappers are on).
+// The report goes nowhere. The two alternate REPEATS times and each time is
+// the best of its runs, so drift on a busy host hits both alike.
+// usage: bench/policy [numOfProcs] [tmpdir]
+
+const int REPEATS = 5;
+
+bool writeWorkload(const string &path, const size_t numOfProcs)
+{
+  mt19937 gen(17);
+  uniform_int_distribution<int> tc(1, 200), cb(1, 20), io(1, 20);
+  exponential_distribution<double> gap(1.0 / 120); // about 0.85 CPU load
+  FILE *f = fopen(path.c_str(), "w");
+  if (f == nullptr)
+  {
+    return false;
+  }
+  double arrival = 0;
+  for (size_t i = 0; i < numOfProcs; i++)
+  {
+    arrival += gap(gen);
+    fprintf(f, "%d %d %d %d\n", static_cast<int>(arrival), tc(gen), cb(gen), io(gen));
+  }
+  return fclose(f) == 0;
+}
+
+// seconds of one run
+template <class Policy, class Calls = Policy>
+double timeRun(const string &input, const RandomNumbers &randNumbers, const char queueKind, const string &spec)
+{
+  char sched;
+  int quantum, maxprio;
+  parseSchedSpec(spec, sched, quantum, maxprio);
+
+  NullBuf null;
+  ostream out(&null);
+  ProcessTable procs;
+  ArrivalSource arrivals(input, randNumbers, maxprio);
+  RandomStream burstRand(randNumbers, arrivals.firstBurstOffset());
+  unique_ptr<EventQueue> evtQ(createEventQueue(queueKind));
+  SimOptions opts;
+
+  auto start = chrono::steady_clock::now();
+  PolicySimulation<Policy, Calls>(procs, arrivals, *evtQ, burstRand, sched, quantum, maxprio, opts, out, out);
+  return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+template <class Policy>
+void compare(const string &input, const RandomNumbers &randNumbers, const char queueKind, const string &spec)
+{
+  double direct = numeric_limits<double>::max(), dispatched = direct;
+  for (int r = 0; r < REPEATS; r++)
+  {
+    direct = min(direct, timeRun<Policy>(input, randNumbers, queueKind, spec));
+    dispatched = min(dispatched, timeRun<Policy, Scheduler>(input, randNumbers, queueKind, spec));
+  }
+  printf("%s\t%c\t%.4lf\t%.4lf\t%.3lf\n", spec.c_str(), queueKind, dispatched, direct,
+         direct > 0 ? dispatched / direct : 0.0);
+  fflush(stdout);
+  return;
+}
+
+int main(int argc, char **argv)
+{
+  const size_t numOfProcs = (argc > 1) ? atol(argv[1]) : 1000000;
+  const string tmp = benchTmpPath((argc > 2) ? argv[2] : nullptr);
+
+  const string rand = tmp + ".rand", input = tmp + ".in";
+  if (!writeRandFile(rand) || !writeWorkload(input, numOfProcs))
+  {
+    cerr << "Error: cannot write the workload to " << tmp << ".*" << endl;
+    unlink(rand.c_str());
+    return 1;
+  }
+  RandomNumbers randNumbers(rand);
+
+  printf("#%zu processes, best of %d runs\n", numOfProcs, REPEATS);
+  printf("#sched\tqueue\tvirtual(s)\tdirect(s)\tspeedup\n");
+  for (const char queueKind : {'m', 'w'})
+  {
+    compare<FCFS>(input, randNumbers, queueKind, "F");
+    compare<RR>(input, randNumbers, queueKind, "R2");
+    compare<RR>(input, randNumbers, queueKind, "R10");
+  }
+  unlink(input.c_str());
+  unlink(rand.c_str());
+  return 0;
+}
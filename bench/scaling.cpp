@@ -0,0 +1,231 @@
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Workload.h"
+
+// the simulator itself, without its command line
+#define main desMain
+#include "../DES.cpp"
+#undef main
+
+// Throughput scaling benchmark: synthetic workloads of 1e3 .. maxProcs
+// processes (powers of ten) in three burst/IO mixes, each run with every
+// scheduler. Every run is a forked child, so its peak RSS is its own.
+// Prints one tab-separated line per run (the header starts with '#'); the
+// columns and their order are kept stable so results can be diffed.
+// usage: bench/scaling [maxProcs] [tmpdir]
+
+// heap allocations made by Simulation(), counted by the replaced operator
+// new family; every overload goes through countedAlloc() / countedFree()
+static uint64_t allocations = 0;
+
+static void *countedAlloc(size_t size, const size_t align, const bool nothrow)
+{
+  allocations++;
+  void *p = nullptr;
+  if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+  {
+    p = malloc(size == 0 ? 1 : size);
+  }
+  else if (posix_memalign(&p, align, size == 0 ? 1 : size) != 0)
+  {
+    p = nullptr;
+  }
+  if (p == nullptr && !nothrow)
+  {
+    throw bad_alloc();
+  }
+  return p;
+}
+
+static void countedFree(void *p) noexcept
+{
+  free(p); // posix_memalign memory is freed the same way
+}
+
+void *operator new(size_t size) { return countedAlloc(size, 0, false); }
+void *operator new[](size_t size) { return countedAlloc(size, 0, false); }
+void *operator new(size_t size, const nothrow_t &) noexcept { return countedAlloc(size, 0, true); }
+void *operator new[](size_t size, const nothrow_t &) noexcept { return countedAlloc(size, 0, true); }
+void *operator new(size_t size, align_val_t align) { return countedAlloc(size, static_cast<size_t>(align), false); }
+void *operator new[](size_t size, align_val_t align) { return countedAlloc(size, static_cast<size_t>(align), false); }
+void *operator new(size_t size, align_val_t align, const nothrow_t &) noexcept
+{
+  return countedAlloc(size, static_cast<size_t>(align), true);
+}
+void *operator new[](size_t size, align_val_t align, const nothrow_t &) noexcept
+{
+  return countedAlloc(size, static_cast<size_t>(align), true);
+}
+
+void operator delete(void *p) noexcept { countedFree(p); }
+void operator delete[](void *p) noexcept { countedFree(p); }
+void operator delete(void *p, size_t) noexcept { countedFree(p); }
+void operator delete[](void *p, size_t) noexcept { countedFree(p); }
+void operator delete(void *p, const nothrow_t &) noexcept { countedFree(p); }
+void operator delete[](void *p, const nothrow_t &) noexcept { countedFree(p); }
+void operator delete(void *p, align_val_t) noexcept { countedFree(p); }
+void operator delete[](void *p, align_val_t) noexcept { countedFree(p); }
+void operator delete(void *p, size_t, align_val_t) noexcept { countedFree(p); }
+void operator delete[](void *p, size_t, align_val_t) noexcept { countedFree(p); }
+void operator delete(void *p, align_val_t, const nothrow_t &) noexcept { countedFree(p); }
+void operator delete[](void *p, align_val_t, const nothrow_t &) noexcept { countedFree(p); }
+
+// how the processes of a workload are drawn; bursts are 1 + rand % CB (IO)
+// in the simulator, so these set the mean of each process's bursts
+struct Mix
+{
+  const char *name;
+  int minCb, maxCb, minIo, maxIo;
+  bool heavyTail; // total CPU time lognormal instead of uniform
+};
+
+const Mix MIXES[] = {
+    {"cpu", 10, 100, 1, 10, false}, // long bursts, little IO
+    {"io", 1, 10, 50, 500, false},  // short bursts, long IO
+    {"heavy", 1, 50, 1, 200, true}, // a few very long processes among many short ones
+};
+
+const char *const SPECS[] = {"F", "L", "S", "R10", "P10", "E10"};
+
+// CPU load the arrivals are spaced for, below 1 so queues stay bounded
+const double LOAD = 0.8;
+
+bool writeWorkload(const string &path, const size_t numOfProcs, const Mix &mix)
+{
+  mt19937 gen(11);
+  uniform_int_distribution<int> cb(mix.minCb, mix.maxCb), io(mix.minIo, mix.maxIo), tc(1, 80);
+  lognormal_distribution<double> heavy(3.0, 1.2);
+
+  vector<int> totalCpu(numOfProcs);
+  double sum = 0;
+  for (int &t : totalCpu)
+  {
+    t = mix.heavyTail ? min(1 + static_cast<int>(heavy(gen)), 100000) : tc(gen);
+    sum += t;
+  }
+  exponential_distribution<double> gap(LOAD * numOfProcs / sum);
+
+  FILE *f = fopen(path.c_str(), "w");
+  if (f == nullptr)
+  {
+    return false;
+  }
+  double arrival = 0;
+  for (const int t : totalCpu)
+  {
+    arrival += gap(gen);
+    fprintf(f, "%d %d %d %d\n", static_cast<int>(arrival), t, cb(gen), io(gen));
+  }
+  return fclose(f) == 0;
+}
+
+struct RunResult
+{
+  uint64_t events, allocations;
+  double seconds;
+};
+
+// runs in the forked child
+RunResult runOne(const string &input, const string &rand, const string &spec)
+{
+  char sched;
+  int quantum, maxprio;
+  parseSchedSpec(spec, sched, quantum, maxprio);
+
+  NullBuf null;
+  ostream out(&null);
+  RandomNumbers randNumbers(rand);
+  ProcessTable procs;
+  ArrivalSource arrivals(input, randNumbers, maxprio);
+  RandomStream burstRand(randNumbers, arrivals.firstBurstOffset());
+  MultimapEventQueue evtQ;
+  SimOptions opts;
+
+  allocations = 0;
+  auto start = chrono::steady_clock::now();
+  Simulation(procs, arrivals, evtQ, burstRand, sched, quantum, maxprio, opts, out, out);
+  auto stop = chrono::steady_clock::now();
+  return {evtQ.inserted(), allocations, chrono::duration<double>(stop - start).count()};
+}
+
+bool runForked(const string &input, const string &rand, const string &spec, RunResult &result, long &peakRssKb)
+{
+  int fds[2];
+  if (pipe(fds) != 0)
+  {
+    return false;
+  }
+  cout.flush();
+  const pid_t child = fork();
+  if (child == 0)
+  {
+    close(fds[0]);
+    const RunResult r = runOne(input, rand, spec);
+    const bool ok = write(fds[1], &r, sizeof(r)) == static_cast<ssize_t>(sizeof(r));
+    _exit(ok ? 0 : 1);
+  }
+  close(fds[1]);
+  const bool got = child > 0 && read(fds[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+  close(fds[0]);
+
+  int status = 0;
+  struct rusage usage;
+  if (child <= 0 || wait4(child, &status, 0, &usage) != child)
+  {
+    return false;
+  }
+  peakRssKb = usage.ru_maxrss; // KiB on Linux
+  return got && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char **argv)
+{
+  const size_t maxProcs = (argc > 1) ? atol(argv[1]) : 10000000;
+  const string tmp = benchTmpPath((argc > 2) ? argv[2] : nullptr);
+
+  const string rand = tmp + ".rand", input = tmp + ".in";
+  if (!writeRandFile(rand))
+  {
+    cerr << "Error: cannot write " << rand << endl;
+    return 1;
+  }
+
+  printf("#procs\tmix\tsched\tevents\tseconds\tMevents/s\tpeakRSS(KiB)\tallocs\tallocs/event\n");
+  for (size_t numOfProcs = 1000; numOfProcs <= maxProcs; numOfProcs *= 10)
+  {
+    for (const Mix &mix : MIXES)
+    {
+      if (!writeWorkload(input, numOfProcs, mix))
+      {
+        cerr << "Error: cannot write " << input << endl;
+        unlink(rand.c_str());
+        return 1;
+      }
+      for (const char *spec : SPECS)
+      {
+        RunResult r;
+        long rss = 0;
+        if (!runForked(input, rand, spec, r, rss))
+        {
+          cerr << "Error: run " << numOfProcs << " " << mix.name << " " << spec << " failed" << endl;
+          continue;
+        }
+        printf("%zu\t%s\t%s\t%llu\t%.3lf\t%.2lf\t%ld\t%llu\t%.4lf\n", numOfProcs, mix.name, spec,
+               static_cast<unsigned long long>(r.events), r.seconds,
+               r.seconds > 0 ? r.events / r.seconds / 1e6 : 0.0, rss,
+               static_cast<unsigned long long>(r.allocations),
+               r.events == 0 ? 0.0 : static_cast<double>(r.allocations) / r.events);
+        fflush(stdout);
+      }
+    }
+  }
+  unlink(input.c_str());
+  unlink(rand.c_str());
+  return 0;
+}
@@ -0,0 +1,165 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <chrono>
+#include <random>
+using namespace std;
+
+#include "../Process.h"
+#include "../Event.h"
+#include "../TextWriter.h"
+
+// Verbose output benchmark: the previous iostream path (operator<< with
+// setw/setfill and endl per line) vs TextWriter, on synthetic -v lines and
+// report lines. Both must produce the same bytes, which is checked first.
+// usage: bench/textout [#lines] [sink file]
+
+vector<TraceRecord> makeRecords(const size_t n)
+{
+  mt19937 gen(3);
+  uniform_int_distribution<int> small(0, 600), trans(0, 4), state(0, 3);
+  vector<TraceRecord> recs(n);
+  int now = 0;
+  for (size_t i = 0; i < n; i++)
+  {
+    TraceRecord &rec = recs[i];
+    now += small(gen) / 100;
+    rec.timeStamp = now;
+    rec.process = static_cast<ProcIdx>(small(gen) * 17);
+    rec.prev = small(gen);
+    rec.remain_cb = small(gen) / 10;
+    rec.remainCpuTime = small(gen) * 3;
+    rec.prioOrIb = small(gen) % 5 - 1;
+    rec.transition = static_cast<Trans>(trans(gen));
+    rec.state = static_cast<ProcState>(state(gen));
+  }
+  return recs;
+}
+
+ProcessTable makeTable(const size_t n)
+{
+  mt19937 gen(5);
+  uniform_int_distribution<int> small(0, 20000);
+  ProcessTable procs;
+  for (size_t i = 0; i < n; i++)
+  {
+    ProcIdx idx = procs.add(small(gen), small(gen) / 10, small(gen) / 500, small(gen) / 500, small(gen) % 4 + 1);
+    procs.cold[idx].finish_ts = procs.cold[idx].arrival_ts + small(gen);
+    procs.cold[idx].totalIO = small(gen);
+    procs.cold[idx].totalWaiting = small(gen);
+  }
+  return procs;
+}
+
+// the report line as ProcessTable::report() printed it before TextWriter
+void reportIostream(ostream &os, const ProcessTable &procs, const ProcIdx idx)
+{
+  const ProcCold &proc = procs.cold[idx];
+  os << setfill('0') << setw(4) << idx << ": " << setfill(' ')
+     << setw(4) << proc.arrival_ts << " "
+     << setw(4) << proc.totalCpuTime << " "
+     << setw(4) << proc.cpuBurst << " "
+     << setw(4) << proc.ioBurst << " "
+     << setw(1) << proc.staticPriority << " | "
+     << setw(5) << proc.finish_ts << " "
+     << setw(5) << (proc.finish_ts - proc.arrival_ts) << " "
+     << setw(5) << proc.totalIO << " "
+     << setw(5) << proc.totalWaiting;
+}
+
+void writeIostream(ostream &os, const vector<TraceRecord> &recs, const ProcessTable &procs)
+{
+  for (const TraceRecord &rec : recs)
+  {
+    rec.print(os);
+    os << endl;
+  }
+  for (ProcIdx idx = 0; idx < procs.size(); idx++)
+  {
+    reportIostream(os, procs, idx);
+    os << endl;
+  }
+}
+
+void writeBuffered(ostream &os, const vector<TraceRecord> &recs, const ProcessTable &procs)
+{
+  TextWriter out(os);
+  for (const TraceRecord &rec : recs)
+  {
+    rec.print(out);
+    out << '\n';
+  }
+  for (ProcIdx idx = 0; idx < procs.size(); idx++)
+  {
+    procs.report(out, idx);
+    out << '\n';
+  }
+}
+
+// counts the bytes instead of keeping them (tellp() is 0 on /dev/null)
+class CountingBuf : public streambuf
+{
+public:
+  size_t count = 0;
+
+protected:
+  int overflow(int c) override
+  {
+    count++;
+    return c;
+  }
+  streamsize xsputn(const char *, streamsize n) override
+  {
+    count += n;
+    return n;
+  }
+};
+
+template <class WRITE>
+double run(WRITE write, const string &sink, const vector<TraceRecord> &recs, const ProcessTable &procs)
+{
+  ofstream os(sink, ios::binary | ios::trunc);
+  auto start = chrono::steady_clock::now();
+  write(os, recs, procs);
+  os.flush();
+  auto stop = chrono::steady_clock::now();
+  return chrono::duration<double>(stop - start).count();
+}
+
+int main(int argc, char **argv)
+{
+  const size_t numOfLines = (argc > 1) ? atol(argv[1]) : 5000000;
+  const string sink = (argc > 2) ? argv[2] : "/dev/null";
+
+  const vector<TraceRecord> recs = makeRecords(numOfLines);
+  const ProcessTable procs = makeTable(numOfLines / 10);
+
+  // same bytes on a sample first
+  {
+    const vector<TraceRecord> sampleRecs(recs.begin(), recs.begin() + min<size_t>(recs.size(), 100000));
+    ostringstream a, b;
+    writeIostream(a, sampleRecs, procs);
+    writeBuffered(b, sampleRecs, procs);
+    if (a.str() != b.str())
+    {
+      cerr << "Error: TextWriter output differs from the iostream output" << endl;
+      return 1;
+    }
+  }
+
+  CountingBuf counter;
+  ostream counted(&counter);
+  writeBuffered(counted, recs, procs);
+  const double bytes = static_cast<double>(counter.count);
+  const double lines = static_cast<double>(recs.size() + procs.size());
+  cout << "path        seconds   Mlines/s      MB/s" << endl;
+  double t = run(writeIostream, sink, recs, procs);
+  cout << "iostream" << fixed << setprecision(3) << setw(11) << t
+       << setprecision(2) << setw(11) << lines / t / 1e6 << setw(10) << bytes / t / 1e6 << endl;
+  t = run(writeBuffered, sink, recs, procs);
+  cout << "TextWriter" << setprecision(3) << setw(9) << t
+       << setprecision(2) << setw(11) << lines / t / 1e6 << setw(10) << bytes / t / 1e6 << endl;
+  return 0;
+}
@@ -0,0 +1,23 @@
+#include <iostream>
+using namespace std;
+
+#include "RandomStream.h"
+
+// Converts a text rand file into the binary format that DES memory-maps.
+// usage: randconv <rfile> <rfile.bin>
+int main(int argc, char **argv)
+{
+  if (argc != 3)
+  {
+    cerr << "usage: " << argv[0] << " <rfile> <rfile.bin>" << endl;
+    return 1;
+  }
+
+  RandomNumbers numbers(argv[1]);
+  if (!numbers.writeBinary(argv[2]))
+  {
+    cerr << "Error: cannot write " << argv[2] << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,28 @@
+#!/bin/bash
+# -e and -t dumps come first; the scheduler name, the report lines and SUM
+# follow them, exactly as a run without dumps prints them.
+# usage: tests/report_order.sh [DES binary]
+DES=${1:-./DES}
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+awk 'BEGIN { for (i = 0; i < 200; i++) print i * 10, 50 + i % 37, 5 + i % 7, 3 + i % 11 }' > "$tmp/in"
+awk 'BEGIN { print 1000; x = 12345; for (i = 0; i < 1000; i++) { x = (x * 16807) % 2147483647; print x } }' > "$tmp/rand"
+
+status=0
+for opt in -t -e; do
+  for spec in F R2 E2; do
+    "$DES" -s$spec "$tmp/in" "$tmp/rand" > "$tmp/plain"
+    "$DES" $opt -s$spec "$tmp/in" "$tmp/rand" > "$tmp/dump"
+    name=$(head -n 1 "$tmp/plain")
+    at=$(grep -n -x -F "$name" "$tmp/dump" | head -n 1 | cut -d: -f1)
+    if [ -z "$at" ] || [ "$at" -le 1 ] ||
+       ! tail -n +"$at" "$tmp/dump" | cmp -s - "$tmp/plain"; then
+      echo "FAIL: $opt -s$spec: the report is not after the dump"
+      status=1
+    else
+      echo "ok: $opt -s$spec"
+    fi
+  done
+done
+exit $status
@@ -0,0 +1,76 @@
+#include <iostream>
+#include <cstring>
+using namespace std;
+
+#include "Trace.h"
+
+// Decodes a binary trace written by "DES -b <trace>" into exactly the text
+// that the same run prints with -v.
+// usage: tracedump <trace>
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    cerr << "usage: " << argv[0] << " <trace>" << endl;
+    return 1;
+  }
+
+  MappedFile file(argv[1]);
+  if (!file.is_open())
+  {
+    cerr << "Error: cannot open trace file " << argv[1] << endl;
+    return 1;
+  }
+
+  const size_t headerSize = sizeof(TRACE_MAGIC) + sizeof(uint32_t);
+  uint32_t recordSize = 0;
+  if (file.size() < headerSize || memcmp(file.begin(), TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0)
+  {
+    cerr << "Error: " << argv[1] << " is not a DES trace" << endl;
+    return 1;
+  }
+  memcpy(&recordSize, file.begin() + sizeof(TRACE_MAGIC), sizeof(recordSize));
+  if (recordSize != sizeof(TraceRecord))
+  {
+    cerr << "Error: " << argv[1] << " has " << recordSize << "-byte records, expected "
+         << sizeof(TraceRecord) << endl;
+    return 1;
+  }
+
+  const char *records = file.begin() + headerSize;
+  size_t count = (file.size() - headerSize) / recordSize;
+  const char *text = nullptr;
+  size_t textLength = 0;
+
+  TraceFooter footer;
+  if (file.size() >= headerSize + sizeof(footer))
+  {
+    memcpy(&footer, file.end() - sizeof(footer), sizeof(footer));
+  }
+  if (file.size() >= headerSize + sizeof(footer) &&
+      memcmp(footer.magic, TRACE_END_MAGIC, sizeof(footer.magic)) == 0 &&
+      headerSize + footer.records * recordSize + footer.textLength + sizeof(footer) == file.size())
+  {
+    count = footer.records;
+    text = file.end() - sizeof(footer) - footer.textLength;
+    textLength = footer.textLength;
+  }
+  else
+  {
+    cerr << "Warning: " << argv[1] << " has no footer (the run did not finish), decoding "
+         << count << " records" << endl;
+  }
+
+  TextWriter out(cout);
+  TraceRecord rec;
+  for (size_t i = 0; i < count; i++)
+  {
+    memcpy(&rec, records + i * recordSize, sizeof(rec));
+    rec.print(out);
+    out << '\n';
+  }
+  out.write(text, textLength);
+  out.flush();
+  cout.flush();
+  return 0;
+}